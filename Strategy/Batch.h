@@ -0,0 +1,213 @@
+#pragma once
+#include"Position.h"
+#include"Random.h"
+#include<cstdint>
+
+const int BATCH_LANES = 8; // rollouts played together by one batch
+
+/**
+ * plays BATCH_LANES rollouts from the same board in lockstep
+ * the bitboards of all lanes are stored word by word in vectors of BATCH_LANES words (structure of arrays),
+ * so the threat masks and win checks of every lane come out of the same vector instructions,
+ * only choosing the columns and dropping the stones is done lane by lane
+ * the lanes start with the same player to move and every lane makes one move per step, so the player
+ * to move is the same in all of them; lanes whose game is over sit out the remaining steps
+ * the kernel is compiled twice, with AVX2 and without, and the AVX2 one is taken if the cpu has it
+ */
+template<int H, int W>
+class BatchRollout {
+private:
+    typedef ::Position<H, W> Position;
+    typedef typename Position::Bitboard Bitboard;
+    typedef uint64_t Vec __attribute__((vector_size(BATCH_LANES * 8)));
+
+    // a bitboard per lane, words[i] holds word i of every lane
+    struct Lanes {
+        Vec words[Bitboard::WORDS];
+
+        Lanes operator&(const Lanes &o) const {
+            Lanes r;
+            for (int i = 0; i < Bitboard::WORDS; i++) {
+                r.words[i] = words[i] & o.words[i];
+            }
+            return r;
+        }
+        Lanes operator|(const Lanes &o) const {
+            Lanes r;
+            for (int i = 0; i < Bitboard::WORDS; i++) {
+                r.words[i] = words[i] | o.words[i];
+            }
+            return r;
+        }
+        // same shifts as Bitboard, 0 < s < 64
+        Lanes operator>>(int s) const {
+            Lanes r;
+            for (int i = 0; i < Bitboard::WORDS - 1; i++) {
+                r.words[i] = (words[i] >> s) | (words[i + 1] << (64 - s));
+            }
+            r.words[Bitboard::WORDS - 1] = words[Bitboard::WORDS - 1] >> s;
+            return r;
+        }
+        Lanes operator<<(int s) const {
+            Lanes r;
+            r.words[0] = words[0] << s;
+            for (int i = 1; i < Bitboard::WORDS; i++) {
+                r.words[i] = (words[i] << s) | (words[i - 1] >> (64 - s));
+            }
+            return r;
+        }
+        // lane l of r is not 0 if lane l has a bit set (an out parameter, vectors are not returned by value)
+        void any(Vec &r) const {
+            r = words[0];
+            for (int i = 1; i < Bitboard::WORDS; i++) {
+                r |= words[i];
+            }
+        }
+        Bitboard lane(int l) const {
+            Bitboard b;
+            for (int i = 0; i < Bitboard::WORDS; i++) {
+                b.w[i] = words[i][l];
+            }
+            return b;
+        }
+        void set(int l, int bit) {
+            words[bit >> 6][l] |= (uint64_t)1 << (bit & 63);
+        }
+        void clear(int l, int bit) {
+            words[bit >> 6][l] &= ~((uint64_t)1 << (bit & 63));
+        }
+    };
+
+    // per lane version of Position::threats
+    static inline __attribute__((always_inline)) Lanes threats(const Lanes &s) {
+        Lanes r = (s << 1) & (s << 2) & (s << 3);
+        static const int dirs[3] = {Position::STRIDE, Position::STRIDE - 1, Position::STRIDE + 1};
+        for (int d : dirs) {
+            Lanes p = (s << d) & (s << (2 * d));
+            r = r | (p & (s << (3 * d))) | (p & (s >> d));
+            p = (s >> d) & (s >> (2 * d));
+            r = r | (p & (s << d)) | (p & (s >> (3 * d)));
+        }
+        return r;
+    }
+    // per lane version of Position::isWin, lane l of any is not 0 if lane l is won
+    static inline __attribute__((always_inline)) void wins(const Lanes &s, Vec &any) {
+        any = Vec{};
+        static const int dirs[4] = {1, Position::STRIDE, Position::STRIDE - 1, Position::STRIDE + 1};
+        for (int d : dirs) {
+            Lanes m = s & (s >> d);
+            m = m & (m >> (2 * d));
+            Vec found;
+            m.any(found);
+            any |= found;
+        }
+    }
+
+    // the kernel, heavy rollouts as UCT::heavyRollout, light ones as UCT::lightRollout
+    // returns the sum of the results, +1 for every lane the ai wins, -1 for every lane the user wins
+    template<bool HEAVY>
+    static inline __attribute__((always_inline)) int kernel(const Position &start, bool ai_turn,
+                                                            const ColumnSampler &sampler, Random &rng) {
+        Position lanes[BATCH_LANES]; // top, legal and empty of every lane, their own bitboards go unused
+        Lanes stones[2], threat[2], playable;
+        Bitboard start_playable = start.playable();
+        Bitboard start_threat[2];
+        if (HEAVY) {
+            start_threat[0] = start.threats(false);
+            start_threat[1] = start.threats(true);
+        }
+        for (int l = 0; l < BATCH_LANES; l++) {
+            lanes[l] = start;
+            for (int i = 0; i < Bitboard::WORDS; i++) {
+                stones[0].words[i][l] = start.stones[0].w[i];
+                stones[1].words[i][l] = start.stones[1].w[i];
+                playable.words[i][l] = start_playable.w[i];
+                if (HEAVY) {
+                    threat[0].words[i][l] = start_threat[0].w[i];
+                    threat[1].words[i][l] = start_threat[1].w[i];
+                }
+            }
+        }
+
+        int profit = 0;
+        int active = BATCH_LANES;
+        bool running[BATCH_LANES];
+        for (int l = 0; l < BATCH_LANES; l++) {
+            running[l] = true;
+        }
+        while (active) {
+            Lanes block;
+            Vec won, blocks; // lane l is not 0 if the player to move can win, or has to block, in lane l
+            if (HEAVY) {
+                Lanes win = threat[ai_turn] & playable;
+                block = threat[!ai_turn] & playable;
+                win.any(won);
+                block.any(blocks);
+            }
+            for (int l = 0; l < BATCH_LANES; l++) {
+                if (!running[l]) {
+                    continue;
+                }
+                Position &lane = lanes[l];
+                if (lane.isFull()) {
+                    running[l] = false;
+                    active--;
+                    continue;
+                }
+                int y;
+                if (HEAVY) {
+                    if (won[l]) {
+                        profit += ai_turn ? 1 : -1;
+                        running[l] = false;
+                        active--;
+                        continue;
+                    }
+                    y = blocks[l] ? block.lane(l).first() / Position::STRIDE : sampler.pick(lane.legal, rng);
+                } else {
+                    y = sampler.pick(lane.legal, rng);
+                }
+                // drop the stone, lane keeps top, legal and empty
+                int x = lane.play(y, ai_turn);
+                int bit = lane.bit(x, y);
+                stones[ai_turn].set(l, bit);
+                if (HEAVY) {
+                    playable.clear(l, bit);
+                    if (lane.canPlay(y)) {
+                        playable.set(l, lane.bit(lane.top[y] - 1, y));
+                    }
+                }
+            }
+            if (HEAVY) {
+                threat[ai_turn] = threats(stones[ai_turn]);
+            } else {
+                wins(stones[ai_turn], won);
+                for (int l = 0; l < BATCH_LANES; l++) {
+                    if (running[l] && won[l]) {
+                        profit += ai_turn ? 1 : -1;
+                        running[l] = false;
+                        active--;
+                    }
+                }
+            }
+            ai_turn = !ai_turn;
+        }
+        return profit;
+    }
+
+    __attribute__((target("avx2"))) static int runAvx2(const Position &start, bool ai_turn, bool heavy,
+                                                       const ColumnSampler &sampler, Random &rng) {
+        return heavy ? kernel<true>(start, ai_turn, sampler, rng) : kernel<false>(start, ai_turn, sampler, rng);
+    }
+    static int runGeneric(const Position &start, bool ai_turn, bool heavy,
+                          const ColumnSampler &sampler, Random &rng) {
+        return heavy ? kernel<true>(start, ai_turn, sampler, rng) : kernel<false>(start, ai_turn, sampler, rng);
+    }
+
+public:
+    // play BATCH_LANES rollouts from start, ai_turn is the player to move, and return the sum of their results
+    // start must not be won already
+    static int run(const Position &start, bool ai_turn, bool heavy, const ColumnSampler &sampler, Random &rng) {
+        static const bool avx2 = __builtin_cpu_supports("avx2");
+        return avx2 ? runAvx2(start, ai_turn, heavy, sampler, rng) : runGeneric(start, ai_turn, heavy, sampler, rng);
+    }
+};
@@ -0,0 +1,321 @@
+#include"Board.h"
+#include"UCT.h"
+#include<algorithm>
+#include<chrono>
+#include<cstdint>
+#include<cstdio>
+#include<cstdlib>
+#include<cstring>
+#include<map>
+#include<string>
+#include<vector>
+#include<sys/resource.h>
+
+/**
+ * benchmark of the engine, built and run by `make bench`
+ * a fixed suite of positions covering board sizes, banned spots and game phases is searched
+ * for a fixed number of iterations on one thread with fixed seeds, so every run does the same work
+ * (the node counts have to match the baseline exactly, only the speeds may differ)
+ * with --threads N it measures how the parallel search scales instead: the suite is searched with
+ * 1, 2, 4, ... N threads, root-parallel and tree-parallel, each thread running BENCH_ITERATIONS,
+ * and the nodes and rollouts per second of the wall clock are reported per thread count
+ * usage: bench [baseline file] [--save], --save writes the results as the new baseline
+ *        bench --threads N
+ */
+
+const int BENCH_ITERATIONS = 100000; // iterations of the search per position
+const int BENCH_RUNS = 3; // searches per position
+const int PROBE_ITERATIONS = 1000; // iterations of the search that checks a candidate position
+const int WIN_CHECK_ROUNDS = 2000; // times every stone of a position is checked by machineWin and isWin
+
+typedef std::chrono::steady_clock Clock;
+
+static double since(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// a position of the suite: a game of the given size played at random up to a share of the board,
+// the user moving first and every move leaving the board quiet, so that the search does not answer at once
+// seeds from seed on are tried until the search finds a position it does not prove within a few iterations
+struct Case {
+    const char *name;
+    int h, w, noX, noY;
+    double filled;
+    uint32_t seed;
+};
+
+// play the game of c from seed into board, false if a move cannot keep the board quiet
+// (quiet: neither player can win with the next stone)
+static bool build(const Case &c, uint32_t seed, Board &board) {
+    GameRandom random(seed);
+    int stones = (int)(c.filled * (c.h * c.w - 1)) | 1; // the ai is to move
+    for (int k = 0; k < stones; k++) {
+        bool ai = k % 2;
+        int y = random.column(board, [&board, ai](int y) {
+            Board next = board;
+            return !next.play(y, ai) && !next.threatened();
+        });
+        if (y < 0) {
+            return false;
+        }
+        board.play(y, ai);
+    }
+    return true;
+}
+
+// the configuration of every search of the bench: the defaults, whatever the environment sets,
+// searching for a fixed number of iterations, on one thread unless the scaling is measured
+// deterministically, except for a shared tree whose threads interleave differently on every run
+static SearchConfig benchConfig(int iterations, int threads = 1, bool tree_parallel = false) {
+    SearchConfig config(false);
+    config.threads = threads;
+    config.tree_parallel = tree_parallel;
+    config.iterations = iterations;
+    config.deterministic = !tree_parallel;
+    config.seed = 1;
+    config.solver_empty = 0; // the tree search is measured, even in the endgame
+    config.stats = true;
+    config.resolve();
+    return config;
+}
+
+template<int H, int W>
+static SearchStats search(const Board &board, const SearchConfig &config) {
+    UCT<H, W> uct(config);
+    uct.move(board.cells.data(), board.top.data(), board.noX, board.noY, -1, -1);
+    return uct.lastStats();
+}
+
+// the position of c: the game from the first seed on whose position the search does not prove at once
+template<int H, int W>
+static Board find(const Case &c) {
+    Board board(H, W, c.noX, c.noY);
+    for (uint32_t seed = c.seed; ; seed++) {
+        board = Board(H, W, c.noX, c.noY);
+        // a proven position keeps its tree small, a growing one has a node or more per iteration
+        if (build(c, seed, board) && search<H, W>(board, benchConfig(PROBE_ITERATIONS)).nodes >= PROBE_ITERATIONS) {
+            return board;
+        }
+    }
+}
+
+struct Result {
+    double rollouts_per_sec, nodes_per_sec;
+    uint64_t nodes;
+    double machine_win_ns, is_win_ns;
+};
+
+template<int H, int W>
+static Result measure(const Case &c) {
+    Board board = find<H, W>(c);
+    Result r = Result();
+    for (int run = 0; run < BENCH_RUNS; run++) { // the same search every run, the fastest one counts
+        SearchStats stats = search<H, W>(board, benchConfig(BENCH_ITERATIONS));
+        r.rollouts_per_sec = std::max(r.rollouts_per_sec, stats.playouts / stats.default_policy);
+        r.nodes_per_sec = std::max(r.nodes_per_sec, stats.nodes / stats.seconds);
+        r.nodes = stats.nodes;
+    }
+
+    // win checks of the framework's judge and of the search on every stone of the ai
+    std::vector<std::pair<int, int> > stones;
+    for (int x = 0; x < H; x++) {
+        for (int y = 0; y < W; y++) {
+            if (board.cells[x * W + y] == 2) {
+                stones.push_back(std::make_pair(x, y));
+            }
+        }
+    }
+    volatile int sink = 0;
+    Clock::time_point start = Clock::now();
+    for (int round = 0; round < WIN_CHECK_ROUNDS; round++) {
+        for (const std::pair<int, int> &stone : stones) {
+            sink += machineWin(stone.first, stone.second, H, W, board.rows.data());
+        }
+    }
+    r.machine_win_ns = stones.empty() ? 0 : since(start) * 1e9 / ((double)WIN_CHECK_ROUNDS * stones.size());
+    Position<H, W> pos(board.cells.data(), board.top.data(), board.noX, board.noY);
+    start = Clock::now();
+    for (int round = 0; round < WIN_CHECK_ROUNDS * 4; round++) {
+        asm volatile("" : : "r"(&pos) : "memory"); // keeps the checks from being hoisted out of the loop
+        sink += pos.isWin(round & 1);
+    }
+    r.is_win_ns = since(start) * 1e9 / (WIN_CHECK_ROUNDS * 4.0);
+    return r;
+}
+
+// the thread counts the scaling is measured with: 1, 2, 4, ... max_threads
+static std::vector<int> threadCounts(int max_threads) {
+    std::vector<int> counts;
+    for (int threads = 1; threads < max_threads; threads *= 2) {
+        counts.push_back(threads);
+    }
+    counts.push_back(max_threads);
+    return counts;
+}
+
+// nodes and rollouts per second of the wall clock, root-parallel [0] and tree-parallel [1]
+struct Scaling {
+    double nodes_per_sec[2], rollouts_per_sec[2];
+};
+
+// the position of c searched with every thread count, each thread running BENCH_ITERATIONS
+template<int H, int W>
+static std::vector<Scaling> scale(const Case &c, int max_threads) {
+    Board board = find<H, W>(c);
+    std::vector<Scaling> results;
+    for (int threads : threadCounts(max_threads)) {
+        Scaling r;
+        for (int tree = 0; tree < 2; tree++) {
+            SearchStats stats = search<H, W>(board, benchConfig(BENCH_ITERATIONS * threads, threads, tree));
+            r.nodes_per_sec[tree] = stats.nodes / stats.seconds;
+            r.rollouts_per_sec[tree] = stats.playouts / stats.seconds;
+        }
+        results.push_back(r);
+    }
+    return results;
+}
+
+// the suite, one pair of functions per size since the search is compiled per size
+struct Entry {
+    Case position;
+    Result (*run)(const Case&);
+    std::vector<Scaling> (*scale)(const Case&, int);
+};
+
+static const Entry SUITE[] = {
+    {{"9x9.open", 9, 9, 8, 4, 0.05, 1}, &measure<9, 9>, &scale<9, 9>},
+    {{"9x12.mid", 9, 12, 4, 6, 0.35, 2}, &measure<9, 12>, &scale<9, 12>},
+    {{"12x9.late", 12, 9, 0, 0, 0.65, 3}, &measure<12, 9>, &scale<12, 9>},
+    {{"10x10.open", 10, 10, 9, 0, 0.05, 4}, &measure<10, 10>, &scale<10, 10>},
+    {{"10x11.late", 10, 11, 3, 7, 0.65, 5}, &measure<10, 11>, &scale<10, 11>},
+    {{"11x10.mid", 11, 10, 10, 9, 0.35, 6}, &measure<11, 10>, &scale<11, 10>},
+    {{"12x12.open", 12, 12, 6, 5, 0.05, 7}, &measure<12, 12>, &scale<12, 12>},
+    {{"12x12.mid", 12, 12, 11, 11, 0.35, 8}, &measure<12, 12>, &scale<12, 12>},
+    {{"12x12.late", 12, 12, 2, 3, 0.65, 9}, &measure<12, 12>, &scale<12, 12>},
+};
+
+static std::map<std::string, double> readBaseline(const char *path) {
+    std::map<std::string, double> values;
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        return values;
+    }
+    char name[128];
+    double value;
+    while (fscanf(file, "%127s %lf", name, &value) == 2) {
+        values[name] = value;
+    }
+    fclose(file);
+    return values;
+}
+
+// the suite searched with 1, 2, 4, ... max_threads threads, root-parallel and tree-parallel,
+// a thread count weighs every position the same, as the totals of the suite do
+static void scaling(int max_threads) {
+    printf("config of the largest search: %s\n",
+           benchConfig(BENCH_ITERATIONS * max_threads, max_threads, true).describe().c_str());
+    std::vector<int> counts = threadCounts(max_threads);
+    std::vector<Scaling> time(counts.size(), Scaling()); // summed seconds per node and per rollout
+    for (const Entry &entry : SUITE) {
+        std::vector<Scaling> results = entry.scale(entry.position, max_threads);
+        for (size_t i = 0; i < counts.size(); i++) {
+            for (int tree = 0; tree < 2; tree++) {
+                time[i].nodes_per_sec[tree] += 1 / results[i].nodes_per_sec[tree];
+                time[i].rollouts_per_sec[tree] += 1 / results[i].rollouts_per_sec[tree];
+            }
+        }
+    }
+    int suite_size = sizeof(SUITE) / sizeof(SUITE[0]);
+    printf("%8s %16s %16s %16s %16s %9s %9s\n", "threads", "root nodes/s", "tree nodes/s",
+           "root rollouts/s", "tree rollouts/s", "root x", "tree x");
+    for (size_t i = 0; i < counts.size(); i++) {
+        double root = suite_size / time[i].nodes_per_sec[0], tree = suite_size / time[i].nodes_per_sec[1];
+        printf("%8d %16.1f %16.1f %16.1f %16.1f %8.2fx %8.2fx\n", counts[i], root, tree,
+               suite_size / time[i].rollouts_per_sec[0], suite_size / time[i].rollouts_per_sec[1],
+               root * time[0].nodes_per_sec[0] / suite_size, tree * time[0].nodes_per_sec[1] / suite_size);
+    }
+}
+
+int main(int argc, char **argv) {
+    const char *baseline_path = nullptr;
+    bool save = false;
+    int max_threads = 0;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--save")) {
+            save = true;
+        } else if (!strcmp(argv[i], "--threads") && i + 1 < argc) {
+            max_threads = atoi(argv[++i]);
+        } else {
+            baseline_path = argv[i];
+        }
+    }
+    if (max_threads > 0) {
+        scaling(max_threads);
+        return 0;
+    }
+
+    printf("config: %s\n", benchConfig(BENCH_ITERATIONS).describe().c_str());
+
+    // the results in the order they are printed, each with its name in the baseline file
+    std::vector<std::pair<std::string, double> > results;
+    double playouts_time = 0, nodes_time = 0, machine_win = 0, is_win = 0;
+    int suite_size = sizeof(SUITE) / sizeof(SUITE[0]);
+    for (const Entry &entry : SUITE) {
+        Result r = entry.run(entry.position);
+        std::string name = entry.position.name;
+        results.push_back(std::make_pair("rollouts_per_sec." + name, r.rollouts_per_sec));
+        results.push_back(std::make_pair("nodes_per_sec." + name, r.nodes_per_sec));
+        results.push_back(std::make_pair("nodes." + name, (double)r.nodes));
+        // the totals weigh every position the same: the mean time per rollout, per node and per check
+        playouts_time += 1 / r.rollouts_per_sec;
+        nodes_time += 1 / r.nodes_per_sec;
+        machine_win += r.machine_win_ns;
+        is_win += r.is_win_ns;
+    }
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    results.push_back(std::make_pair("rollouts_per_sec", suite_size / playouts_time));
+    results.push_back(std::make_pair("nodes_per_sec", suite_size / nodes_time));
+    results.push_back(std::make_pair("machine_win_ns", machine_win / suite_size));
+    results.push_back(std::make_pair("is_win_ns", is_win / suite_size));
+    results.push_back(std::make_pair("peak_memory_mb", usage.ru_maxrss / 1024.0));
+
+    std::map<std::string, double> baseline;
+    if (baseline_path) {
+        baseline = readBaseline(baseline_path);
+    }
+    printf("%-28s %14s %14s %9s\n", "", "now", "baseline", "change");
+    for (const std::pair<std::string, double> &result : results) {
+        std::map<std::string, double>::const_iterator base = baseline.find(result.first);
+        if (base == baseline.end() || base->second == 0) {
+            printf("%-28s %14.1f %14s %9s\n", result.first.c_str(), result.second, "-", "");
+        } else {
+            double change = 100 * (result.second / base->second - 1);
+            printf("%-28s %14.1f %14.1f %+8.1f%%\n", result.first.c_str(), result.second, base->second, change);
+        }
+    }
+    int mismatches = 0; // searches that did not do the same work as in the baseline
+    for (const std::pair<std::string, double> &result : results) {
+        std::map<std::string, double>::const_iterator base = baseline.find(result.first);
+        if (!result.first.compare(0, 6, "nodes.") && base != baseline.end() && base->second != result.second) {
+            mismatches++;
+        }
+    }
+    if (mismatches) {
+        printf("%d node counts differ from the baseline, the search itself changed\n", mismatches);
+    }
+
+    if (save && baseline_path) {
+        FILE *file = fopen(baseline_path, "w");
+        if (!file) {
+            perror(baseline_path);
+            return 1;
+        }
+        for (const std::pair<std::string, double> &result : results) {
+            fprintf(file, "%s %.1f\n", result.first.c_str(), result.second);
+        }
+        fclose(file);
+        printf("saved as %s\n", baseline_path);
+    }
+    return 0;
+}
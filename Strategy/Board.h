@@ -0,0 +1,123 @@
+#pragma once
+#include"Judge.h"
+#include<cstdint>
+#include<vector>
+
+/**
+ * the board as the framework keeps it, for the tools around the search (bench, perft and the checks):
+ * the cells row by row (0 empty, 1 user, 2 ai), the top of every column,
+ * and the int** form the judge functions of Judge.h take
+ * stones are dropped as Compete does, stepping over the banned spot
+ */
+struct Board {
+    int h, w, noX, noY;
+    std::vector<int> cells;
+    std::vector<int> top;
+    std::vector<int*> rows;
+
+    Board(int _h, int _w, int _noX, int _noY)
+        : h(_h), w(_w), noX(_noX), noY(_noY), cells(_h * _w), top(_w, _h), rows(_h) {
+        for (int i = 0; i < h; i++) {
+            rows[i] = &cells[i * w];
+        }
+        if (noX == h - 1) {
+            top[noY]--;
+        }
+    }
+    Board(const Board &o) : h(o.h), w(o.w), noX(o.noX), noY(o.noY), cells(o.cells), top(o.top), rows(o.h) {
+        for (int i = 0; i < h; i++) {
+            rows[i] = &cells[i * w];
+        }
+    }
+    Board& operator=(const Board &o) { // between boards of the same game
+        cells = o.cells;
+        top = o.top;
+        return *this;
+    }
+
+    bool canPlay(int y) const {
+        return top[y] > 0;
+    }
+    // drop a stone into column y and return its row
+    int drop(int y, bool ai) {
+        int x = --top[y];
+        cells[x * w + y] = ai ? 2 : 1;
+        if (x - 1 == noX && y == noY) {
+            top[y]--;
+        }
+        return x;
+    }
+    // take back the stone at (x, y), old_top is the top of column y before it was dropped
+    void undo(int x, int y, int old_top) {
+        cells[x * w + y] = 0;
+        top[y] = old_top;
+    }
+    // whether the stone at (x, y) won, by the judge
+    bool wins(int x, int y, bool ai) const {
+        return ai ? machineWin(x, y, h, w, rows.data()) : userWin(x, y, h, w, rows.data());
+    }
+    // drop a stone into column y and return whether it won
+    bool play(int y, bool ai) {
+        int x = drop(y, ai);
+        return wins(x, y, ai);
+    }
+    // whether a stone of the player in column y would win
+    bool winsAt(int y, bool ai) const {
+        Board next = *this;
+        return next.play(y, ai);
+    }
+    // whether either player can win with the next stone
+    bool threatened() const {
+        for (int y = 0; y < w; y++) {
+            if (canPlay(y) && (winsAt(y, false) || winsAt(y, true))) {
+                return true;
+            }
+        }
+        return false;
+    }
+    bool tie() const {
+        return isTie(w, top.data());
+    }
+};
+
+/**
+ * linear congruential generator of the random games of the tools
+ * small and the same on every platform, so that a seed always gives the same positions
+ */
+struct GameRandom {
+    uint64_t state;
+
+    explicit GameRandom(uint64_t seed) : state(seed) {}
+    // a number in [0, n)
+    int below(int n) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        return (int)((state >> 33) % n);
+    }
+    // the first column from a random one, going right and wrapping around, where accept(y) holds, -1 if none
+    template<class Accept>
+    int column(const Board &board, Accept accept) {
+        int first = below(board.w);
+        for (int i = 0; i < board.w; i++) {
+            int y = (first + i) % board.w;
+            if (board.canPlay(y) && accept(y)) {
+                return y;
+            }
+        }
+        return -1;
+    }
+};
+
+// play random stones on board, the user moving first, until stop(ai) holds with ai to move,
+// returns false if the game ended before
+template<class Stop>
+bool randomGame(Board &board, GameRandom &random, Stop stop) {
+    for (bool ai = false; ; ai = !ai) {
+        if (stop(ai)) {
+            return true;
+        }
+        int y = random.column(board, [](int) { return true; });
+        if (y < 0 || board.play(y, ai) || board.tie()) {
+            return false;
+        }
+    }
+}
@@ -0,0 +1,123 @@
+#pragma once
+#include<cstdio>
+#include<cstdlib>
+#include<cstring>
+#include<string>
+#include<thread>
+
+const int DETERMINISTIC_ITERATIONS = 100000; // iterations per move of a seeded search that was given no budget
+
+/**
+ * tunable parameters of the search
+ * getPoint runs with the defaults, every field can be overridden by an environment variable
+ * so that matches can compare settings without rebuilding the .so
+ * (the bench and the checks ignore the environment, so that they always search the same way)
+ */
+struct SearchConfig {
+    int threads; // number of search threads (CONNECT4_THREADS), 0: one per hardware thread
+    bool tree_parallel; // all threads search one shared tree (CONNECT4_PARALLEL=tree) instead of one tree each (=root)
+    int memory_mb; // megabytes of tree nodes over all trees, both pools of a tree included (CONNECT4_MEMORY_MB)
+    int table_mb; // megabytes of transposition tables over all trees (CONNECT4_TT_MB), 0 disables them
+    int solver_empty; // the endgame solver runs once at most this many spots are empty (CONNECT4_SOLVER_EMPTY), 0: never
+    bool heavy_rollouts; // rollouts take wins and block threats (CONNECT4_ROLLOUT=heavy) instead of playing at random (=light)
+    bool rave; // blend all-moves-as-first statistics into the selection (CONNECT4_RAVE=1)
+    bool batch; // play BATCH_LANES rollouts per leaf in lockstep (CONNECT4_BATCH=1) instead of one, always off with RAVE
+    int iterations; // iterations per move over all threads (CONNECT4_ITERATIONS), 0: the time budget ends the search
+    bool ponder; // keep searching on the opponent's time, between two moves (CONNECT4_PONDER=1)
+    bool deterministic; // every run of a game searches the same trees (on when CONNECT4_SEED is set)
+    int seed; // seed of the search threads when deterministic (CONNECT4_SEED)
+    std::string stats_file; // append a JSON line of search statistics per move to this file (CONNECT4_STATS), empty: off
+    bool stats; // count and time the phases of the search, on with a stats file
+
+    // the defaults, overridden by the environment variables when from_env is set
+    // tools that have to search the same way whatever the shell sets pass false
+    explicit SearchConfig(bool from_env = true)
+        : threads(0), tree_parallel(false), memory_mb(256), table_mb(4), solver_empty(32), heavy_rollouts(true),
+          rave(false), batch(false), iterations(0), ponder(false), deterministic(false), seed(0), stats(false) {
+        if (from_env) {
+            readEnv();
+        }
+        resolve();
+    }
+
+    // make the fields consistent with each other, to be called again after fields were set by hand
+    void resolve() {
+        stats = stats || !stats_file.empty();
+        if (threads <= 0) {
+            threads = std::thread::hardware_concurrency();
+        }
+        if (threads <= 0) { // the hardware concurrency is unknown
+            threads = 1;
+        }
+        if (iterations < 0) {
+            iterations = 0;
+        }
+        // a deterministic search runs a fixed number of iterations with one tree per thread,
+        // threads sharing a tree would interleave differently on every run
+        if (deterministic) {
+            tree_parallel = false;
+            if (!iterations) {
+                iterations = DETERMINISTIC_ITERATIONS;
+            }
+        }
+        if (memory_mb < 1) {
+            memory_mb = 1;
+        }
+        if (iterations) { // the opponent's time would change how much is searched per move
+            ponder = false;
+        }
+        if (rave) { // the RAVE statistics need the final board of every rollout
+            batch = false;
+        }
+    }
+
+    // one line with every field, for the output of the tools
+    std::string describe() const {
+        char line[256];
+        snprintf(line, sizeof(line), "threads %d, parallel %s, memory %d MB, table %d MB, solver %d, rollout %s, rave %d, "
+                 "batch %d, iterations %d, ponder %d, seed %s",
+                 threads, tree_parallel ? "tree" : "root", memory_mb, table_mb, solver_empty, heavy_rollouts ? "heavy" : "light",
+                 rave, batch, iterations, ponder, deterministic ? std::to_string(seed).c_str() : "none");
+        return line;
+    }
+
+private:
+    void readEnv() {
+        readInt("CONNECT4_THREADS", threads);
+        readInt("CONNECT4_MEMORY_MB", memory_mb);
+        readInt("CONNECT4_TT_MB", table_mb);
+        readInt("CONNECT4_SOLVER_EMPTY", solver_empty);
+        readBool("CONNECT4_RAVE", rave);
+        readBool("CONNECT4_BATCH", batch);
+        readInt("CONNECT4_ITERATIONS", iterations);
+        deterministic = readInt("CONNECT4_SEED", seed);
+        readBool("CONNECT4_PONDER", ponder);
+        const char *parallel = getenv("CONNECT4_PARALLEL");
+        if (parallel) {
+            tree_parallel = !strcmp(parallel, "tree");
+        }
+        const char *file = getenv("CONNECT4_STATS");
+        if (file) {
+            stats_file = file;
+        }
+        const char *rollout = getenv("CONNECT4_ROLLOUT");
+        if (rollout) {
+            heavy_rollouts = !strcmp(rollout, "heavy");
+        }
+    }
+    // returns whether the variable is set
+    static bool readInt(const char *name, int &value) {
+        const char *s = getenv(name);
+        if (s && *s) {
+            value = atoi(s);
+            return true;
+        }
+        return false;
+    }
+    static void readBool(const char *name, bool &value) {
+        const char *s = getenv(name);
+        if (s && *s) {
+            value = !!atoi(s);
+        }
+    }
+};
@@ -0,0 +1,75 @@
+#pragma once
+#include"UCTNode.h"
+#include<atomic>
+#include<cstdint>
+#include<cstdlib>
+
+/**
+ * contiguous storage for the nodes of one tree
+ * nodes are handed out by bumping an index and are never freed one by one,
+ * releasing the whole tree is a single reset
+ * the memory is reserved once and reused by every search
+ * allocation is lock free, so the threads of a shared tree can expand it concurrently
+ * the capacity comes from the memory budget of the search (SearchConfig::memory_mb)
+ * with RAVE on, the pool also keeps the AmafStats of every node, at the same index
+ */
+class NodePool {
+private:
+    UCTNode *nodes;
+    AmafStats *amaf; // RAVE statistics of the nodes, nullptr with RAVE off
+    uint32_t capacity; // number of nodes that fit in the pool
+    std::atomic<uint32_t> size; // number of nodes handed out, grows past capacity once the pool is full
+public:
+    static const uint32_t NONE = 0xFFFFFFFF;
+
+    NodePool(uint32_t _capacity, bool rave)
+        : nodes((UCTNode*)malloc(sizeof(UCTNode) * (size_t)_capacity)),
+          amaf(rave ? (AmafStats*)malloc(sizeof(AmafStats) * (size_t)_capacity) : nullptr),
+          capacity(nodes && (amaf || !rave) ? _capacity : 0), size(0) {}
+    ~NodePool() {
+        free(nodes);
+        free(amaf);
+    }
+    NodePool(const NodePool&) = delete;
+    NodePool& operator=(const NodePool&) = delete;
+
+    // reserve count consecutive nodes and return the index of the first one, NONE if the pool is full
+    uint32_t allocate(uint32_t count) {
+        if (size.load(std::memory_order_relaxed) > capacity) { // do not let failed requests grow size
+            return NONE;
+        }
+        uint32_t first = size.fetch_add(count, std::memory_order_relaxed);
+        if (first + count > capacity) {
+            return NONE;
+        }
+        for (uint32_t i = 0; amaf && i < count; i++) {
+            amaf[first + i].clear();
+        }
+        return first;
+    }
+    UCTNode& operator[](uint32_t index) {
+        return nodes[index];
+    }
+    // RAVE statistics of node, a node of this pool, only with RAVE on
+    AmafStats& amafOf(const UCTNode *node) {
+        return amaf[node - nodes];
+    }
+    // copy the node at index of from into the slot to, with its RAVE statistics
+    void copy(uint32_t to, NodePool &from, uint32_t index) {
+        nodes[to] = from.nodes[index];
+        if (amaf) {
+            amaf[to] = from.amaf[index];
+        }
+    }
+    // release every node at once
+    void reset() {
+        size.store(0, std::memory_order_relaxed);
+    }
+    uint32_t used() const {
+        uint32_t n = size.load(std::memory_order_relaxed);
+        return n < capacity ? n : capacity;
+    }
+    uint32_t limit() const {
+        return capacity;
+    }
+};
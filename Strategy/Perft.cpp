@@ -0,0 +1,311 @@
+#include"Board.h"
+#include"Position.h"
+#include<chrono>
+#include<cstdint>
+#include<cstdio>
+#include<cstdlib>
+#include<string>
+#include<vector>
+
+/**
+ * perft of the move generation and the win detection, built and run by `make perft`
+ * every continuation of a start position is played out to a fixed depth twice: by the reference,
+ * the board and top arrays of the framework updated as Compete does and judged by userWin / machineWin / isTie,
+ * and by the engine, Position with its bitboards as the search uses it
+ * both walks count their moves, leaves and game ends, which have to match, and a third walk plays them in lockstep
+ * and compares every node: the columns that can be played, where the stone lands, wins, ties, empty spots,
+ * and whether the player to move can win at once (what threats() & playable() tells the search)
+ * usage: perft                        the built-in suite
+ *        perft M N noX noY depth [moves]  one start position, moves are the columns played before it (0-9, a, b)
+ */
+
+const int MAX_REPORTED = 10; // divergences printed per start position
+const int MAX_DEPTH = 64; // deepest perft
+
+typedef std::chrono::steady_clock Clock;
+
+static double since(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// what a walk counts, the moves played (nodes) and how the continuations end
+struct Counts {
+    uint64_t nodes, leaves, user_wins, ai_wins, ties;
+
+    Counts() : nodes(0), leaves(0), user_wins(0), ai_wins(0), ties(0) {}
+    bool operator==(const Counts &o) const {
+        return nodes == o.nodes && leaves == o.leaves && user_wins == o.user_wins && ai_wins == o.ai_wins && ties == o.ties;
+    }
+};
+
+// a start position: the moves played on an empty board, the user moving first, and the depth to search from it
+struct Start {
+    int h, w, noX, noY;
+    std::string moves;
+    int depth;
+};
+
+// column of a move in the moves of a start position
+static int column(char c) {
+    return c >= 'a' ? c - 'a' + 10 : c - '0';
+}
+
+template<int H, int W>
+class Perft {
+private:
+    typedef ::Position<H, W> Position;
+    typedef typename Position::Bitboard Bitboard;
+
+    const Start &start;
+    int path[MAX_DEPTH]; // columns played from the start position, for the report of a divergence
+    uint64_t divergences;
+
+    void diverge(int depth, const char *what) {
+        if (divergences++ < MAX_REPORTED) {
+            printf("  divergence after moves '%s' + '", start.moves.c_str());
+            for (int i = 0; i < depth; i++) {
+                printf("%c", path[i] < 10 ? '0' + path[i] : 'a' + path[i] - 10);
+            }
+            printf("': %s\n", what);
+        }
+    }
+
+    void walk(Board &board, int depth, bool ai, Counts &counts) {
+        if (depth == 0) {
+            counts.leaves++;
+            return;
+        }
+        for (int y = 0; y < W; y++) {
+            if (board.top[y] <= 0) {
+                continue;
+            }
+            int old_top = board.top[y];
+            int x = board.drop(y, ai);
+            counts.nodes++;
+            if (board.wins(x, y, ai)) {
+                (ai ? counts.ai_wins : counts.user_wins)++;
+            } else if (board.tie()) {
+                counts.ties++;
+            } else {
+                walk(board, depth - 1, !ai, counts);
+            }
+            board.undo(x, y, old_top);
+        }
+    }
+
+    static void walk(const Position &pos, int depth, bool ai, Counts &counts) {
+        if (depth == 0) {
+            counts.leaves++;
+            return;
+        }
+        for (uint16_t legal = pos.legal; legal; legal &= legal - 1) {
+            Position next = pos;
+            next.play(__builtin_ctz(legal), ai);
+            counts.nodes++;
+            if (next.isWin(ai)) {
+                (ai ? counts.ai_wins : counts.user_wins)++;
+            } else if (next.isFull()) {
+                counts.ties++;
+            } else {
+                walk(next, depth - 1, !ai, counts);
+            }
+        }
+    }
+
+    // the reference and the engine side by side, the reference decides how the walk goes on
+    void lockstep(Board &board, const Position &pos, int ply, bool ai) {
+        uint16_t legal = 0;
+        int spots = 0;
+        for (int y = 0; y < W; y++) {
+            if (board.top[y] > 0) {
+                legal |= 1 << y;
+            }
+            if (board.top[y] != pos.top[y]) {
+                diverge(ply, "top differs");
+            }
+            spots += board.top[y] - (board.top[y] > board.noX && y == board.noY);
+        }
+        if (legal != pos.legal) {
+            diverge(ply, "legal columns differ");
+        }
+        if (spots != pos.empty) {
+            diverge(ply, "empty spots differ");
+        }
+        if (ply == start.depth) {
+            return;
+        }
+
+        bool can_win = false; // whether a move of the player to move wins, by the judge
+        for (int y = 0; y < W && !can_win; y++) {
+            if (board.top[y] > 0) {
+                int old_top = board.top[y];
+                int x = board.drop(y, ai);
+                can_win = board.wins(x, y, ai);
+                board.undo(x, y, old_top);
+            }
+        }
+        if (can_win != (pos.threats(ai) & pos.playable()).any()) {
+            diverge(ply, "immediate win differs");
+        }
+
+        for (int y = 0; y < W; y++) {
+            if (board.top[y] <= 0) {
+                continue;
+            }
+            path[ply] = y;
+            int old_top = board.top[y];
+            int x = board.drop(y, ai);
+            Position next = pos;
+            if (!next.canPlay(y) || next.play(y, ai) != x) {
+                diverge(ply + 1, "stone lands elsewhere");
+                board.undo(x, y, old_top);
+                continue;
+            }
+            bool won = board.wins(x, y, ai);
+            if (won != next.isWin(ai)) {
+                diverge(ply + 1, "win differs");
+            }
+            bool tie = !won && board.tie();
+            if (tie != (!won && next.isFull())) {
+                diverge(ply + 1, "tie differs");
+            }
+            if (!won && !tie) {
+                lockstep(board, next, ply + 1, !ai);
+            }
+            board.undo(x, y, old_top);
+        }
+    }
+
+    Perft(const Start &_start) : start(_start), divergences(0) {}
+
+public:
+    // run the three walks from start and print the counts and speeds, returns whether everything matched
+    static bool run(const Start &start) {
+        Perft perft(start);
+        Board board(H, W, start.noX, start.noY);
+        bool ai = false;
+        for (char c : start.moves) {
+            int y = column(c);
+            if (y < 0 || y >= W || board.top[y] <= 0) {
+                printf("%dx%d: illegal move '%c' in '%s'\n", H, W, c, start.moves.c_str());
+                return false;
+            }
+            int x = board.drop(y, ai);
+            if (board.wins(x, y, ai) || board.tie()) {
+                printf("%dx%d: the game is over after '%c' in '%s'\n", H, W, c, start.moves.c_str());
+                return false;
+            }
+            ai = !ai;
+        }
+        Position pos(board.cells.data(), board.top.data(), start.noX, start.noY);
+
+        Counts reference, engine;
+        Clock::time_point mark = Clock::now();
+        perft.walk(board, start.depth, ai, reference);
+        double reference_time = since(mark);
+        mark = Clock::now();
+        walk(pos, start.depth, ai, engine);
+        double engine_time = since(mark);
+        perft.lockstep(board, pos, 0, ai);
+
+        bool ok = reference == engine && !perft.divergences;
+        printf("%2dx%-2d ban %2d,%-2d moves %-3d depth %-2d nodes %10llu leaves %10llu user %8llu ai %8llu ties %6llu"
+               "  judge %6.1f  engine %6.1f Mnodes/s  %s\n",
+               H, W, start.noX, start.noY, (int)start.moves.size(), start.depth, (unsigned long long)reference.nodes,
+               (unsigned long long)reference.leaves, (unsigned long long)reference.user_wins,
+               (unsigned long long)reference.ai_wins, (unsigned long long)reference.ties,
+               reference.nodes / reference_time / 1e6, engine.nodes / engine_time / 1e6, ok ? "ok" : "FAILED");
+        if (!(reference == engine)) {
+            printf("  engine counts: nodes %llu leaves %llu user %llu ai %llu ties %llu\n",
+                   (unsigned long long)engine.nodes, (unsigned long long)engine.leaves,
+                   (unsigned long long)engine.user_wins, (unsigned long long)engine.ai_wins,
+                   (unsigned long long)engine.ties);
+        }
+        if (perft.divergences) {
+            printf("  %llu divergences\n", (unsigned long long)perft.divergences);
+        }
+        return ok;
+    }
+};
+
+// the engine is compiled per board size
+static bool (*const perfts[MAX_SIZE - MIN_SIZE + 1][MAX_SIZE - MIN_SIZE + 1])(const Start&) = {
+    {&Perft<9, 9>::run, &Perft<9, 10>::run, &Perft<9, 11>::run, &Perft<9, 12>::run},
+    {&Perft<10, 9>::run, &Perft<10, 10>::run, &Perft<10, 11>::run, &Perft<10, 12>::run},
+    {&Perft<11, 9>::run, &Perft<11, 10>::run, &Perft<11, 11>::run, &Perft<11, 12>::run},
+    {&Perft<12, 9>::run, &Perft<12, 10>::run, &Perft<12, 11>::run, &Perft<12, 12>::run},
+};
+
+// a start position of stones moves played at random from seed, none of them ending the game
+static Start randomStart(int h, int w, int noX, int noY, int stones, uint32_t seed, int depth) {
+    for (;; seed++) {
+        Board board(h, w, noX, noY);
+        std::string moves;
+        GameRandom random(seed);
+        for (int k = 0; k < stones; k++) {
+            bool ai = k % 2;
+            int y = random.column(board, [&board, ai](int y) { // a stone that does not win
+                Board next = board;
+                return !next.play(y, ai) && !next.tie();
+            });
+            if (y < 0) {
+                break;
+            }
+            board.drop(y, ai);
+            moves += (char)(y < 10 ? '0' + y : 'a' + y - 10);
+        }
+        if ((int)moves.size() == stones) {
+            Start start = {h, w, noX, noY, moves, depth};
+            return start;
+        }
+    }
+}
+
+// openings from the empty board, middle games, and endgames of boards that fill up to a tie,
+// with the banned spot at the bottom, in the middle, at the top and in a corner
+static std::vector<Start> suite() {
+    std::vector<Start> starts;
+    starts.push_back(randomStart(9, 9, 8, 4, 0, 1, 7));
+    starts.push_back(randomStart(9, 12, 4, 0, 0, 1, 6));
+    starts.push_back(randomStart(12, 9, 0, 8, 0, 1, 7));
+    starts.push_back(randomStart(10, 11, 5, 5, 0, 1, 6));
+    starts.push_back(randomStart(11, 10, 10, 0, 0, 1, 6));
+    starts.push_back(randomStart(12, 12, 6, 6, 0, 1, 6));
+    starts.push_back(randomStart(10, 10, 3, 2, 30, 2, 7));
+    starts.push_back(randomStart(12, 12, 11, 11, 50, 3, 6));
+    starts.push_back(randomStart(11, 12, 2, 9, 70, 4, 6));
+    // the last moves of games that end in a tie, the stones alternate in pairs along the rows
+    const Start ties[] = {
+        {9, 9, 0, 0, "1702237661163367335180320073354317782442860721605888147746660444814", 13},
+        {12, 11, 7, 10, "170223769740615672882a17022009907934a1834774339547087a11a4128958a135679a59a04488442a950689117855905229a3120185584a603", 14},
+        {10, 12, 4, 6, "3452945595b8b65652794b4014242a116271651240473804842a23ab098718b0b5aa5b52933886928b6a79307709a701b39190667813a", 10},
+    };
+    starts.insert(starts.end(), ties, ties + sizeof(ties) / sizeof(ties[0]));
+    return starts;
+}
+
+int main(int argc, char **argv) {
+    std::vector<Start> starts;
+    if (argc >= 6) {
+        Start start = {atoi(argv[1]), atoi(argv[2]), atoi(argv[3]), atoi(argv[4]), argc >= 7 ? argv[6] : "", atoi(argv[5])};
+        if (start.h < MIN_SIZE || start.h > MAX_SIZE || start.w < MIN_SIZE || start.w > MAX_SIZE
+            || start.noX < 0 || start.noX >= start.h || start.noY < 0 || start.noY >= start.w
+            || start.depth < 0 || start.depth > MAX_DEPTH) {
+            printf("bad start position\n");
+            return 2;
+        }
+        starts.push_back(start);
+    } else if (argc == 1) {
+        starts = suite();
+    } else {
+        printf("usage: %s [M N noX noY depth [moves]]\n", argv[0]);
+        return 2;
+    }
+
+    int failed = 0;
+    for (const Start &start : starts) {
+        failed += !perfts[start.h - MIN_SIZE][start.w - MIN_SIZE](start);
+    }
+    printf(failed ? "%d start positions FAILED\n" : "all start positions match\n", failed);
+    return failed ? 1 : 0;
+}
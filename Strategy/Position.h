@@ -0,0 +1,259 @@
+#pragma once
+#include<cstdint>
+
+const int MIN_SIZE = 9; // smallest height and width of the boards the framework deals
+const int MAX_SIZE = 12; // largest height and width
+
+/**
+ * a fixed size bitset of WORDS words, the search picks the fewest words that hold its board
+ * every loop runs over the compile-time word count, so the operations unroll
+ */
+template<int WORDS_>
+struct Bitboard {
+    static const int WORDS = WORDS_;
+    uint64_t w[WORDS];
+
+    Bitboard() : w{} {}
+
+    bool test(int bit) const {
+        return (w[bit >> 6] >> (bit & 63)) & 1;
+    }
+    void set(int bit) {
+        w[bit >> 6] |= (uint64_t)1 << (bit & 63);
+    }
+    void clear(int bit) {
+        w[bit >> 6] &= ~((uint64_t)1 << (bit & 63));
+    }
+    bool any() const {
+        uint64_t r = 0;
+        for (int i = 0; i < WORDS; i++) {
+            r |= w[i];
+        }
+        return r != 0;
+    }
+    int count() const {
+        int r = 0;
+        for (int i = 0; i < WORDS; i++) {
+            r += __builtin_popcountll(w[i]);
+        }
+        return r;
+    }
+    // index of the lowest set bit, the bitboard must not be empty
+    int first() const {
+        int i = 0;
+        while (i < WORDS - 1 && !w[i]) {
+            i++;
+        }
+        return 64 * i + __builtin_ctzll(w[i]);
+    }
+
+    Bitboard operator&(const Bitboard &o) const {
+        Bitboard r;
+        for (int i = 0; i < WORDS; i++) {
+            r.w[i] = w[i] & o.w[i];
+        }
+        return r;
+    }
+    Bitboard operator|(const Bitboard &o) const {
+        Bitboard r;
+        for (int i = 0; i < WORDS; i++) {
+            r.w[i] = w[i] | o.w[i];
+        }
+        return r;
+    }
+    Bitboard operator~() const {
+        Bitboard r;
+        for (int i = 0; i < WORDS; i++) {
+            r.w[i] = ~w[i];
+        }
+        return r;
+    }
+    // shift towards lower bits, 0 < s < 64
+    Bitboard operator>>(int s) const {
+        Bitboard r;
+        for (int i = 0; i < WORDS - 1; i++) {
+            r.w[i] = (w[i] >> s) | (w[i + 1] << (64 - s));
+        }
+        r.w[WORDS - 1] = w[WORDS - 1] >> s;
+        return r;
+    }
+    // shift towards higher bits, 0 < s < 64
+    Bitboard operator<<(int s) const {
+        Bitboard r;
+        r.w[0] = w[0] << s;
+        for (int i = 1; i < WORDS; i++) {
+            r.w[i] = (w[i] << s) | (w[i - 1] >> (64 - s));
+        }
+        return r;
+    }
+};
+
+// zobrist key of a stone of the player (0: user, 1: ai, 2: banned spot) on the given bit
+// the keys are generated by splitmix64 instead of being stored in a table
+inline uint64_t zobrist(int player, int bit) {
+    uint64_t z = (uint64_t)(bit * 3 + player + 1) * 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+/**
+ * the board state used by the search, for a board of H rows and W columns
+ * stones of each player are kept as bitboards, top[] follows the same convention as the framework
+ * (the next stone in column y lands on row top[y] - 1, the column is full when top[y] == 0)
+ * and the banned spot is a permanently blocked bit that is skipped when a column grows past it
+ * every column owns H + 1 bits (bottom row = lowest bit), the bit above the top row is never set
+ * and acts as a guard for the shift-and-AND line detection, so 10 of the 16 board sizes fit in two words
+ */
+template<int H, int W>
+class Position {
+public:
+    static const int h = H, w = W; // dimensions of the board
+    static const int STRIDE = H + 1; // bits per column
+    typedef ::Bitboard<(STRIDE * W + 63) / 64> Bitboard;
+
+    int noX, noY; // banned coordinates
+    Bitboard stones[2]; // 0: user, 1: ai (strategy)
+    Bitboard blocked; // the banned spot
+    int top[MAX_SIZE]; // top spot of each column
+    int empty; // number of spots that can still be filled
+    uint16_t legal; // bit y is set while column y is not full
+
+    Position() {}
+    // read straight from the arrays of the framework, _board holds the rows one after the other
+    Position(const int *_board, const int *_top, int _noX, int _noY)
+        : noX(_noX), noY(_noY), empty(0), legal(0) {
+        blocked.set(bit(noX, noY));
+        for (int j = 0; j < w; j++) {
+            top[j] = _top[j];
+            if (top[j] > 0) {
+                legal |= 1 << j;
+            }
+            for (int i = 0; i < h; i++) {
+                int stone = _board[i * w + j];
+                if (stone) {
+                    stones[stone - 1].set(bit(i, j));
+                } else if (i != noX || j != noY) {
+                    empty++;
+                }
+            }
+        }
+    }
+
+    // bit index of row x, column y
+    static int bit(int x, int y) {
+        return y * STRIDE + (h - 1 - x);
+    }
+    bool canPlay(int y) const {
+        return top[y] > 0;
+    }
+    bool isFull() const {
+        return empty == 0;
+    }
+    bool sameGeometry(const Position &o) const {
+        return noX == o.noX && noY == o.noY;
+    }
+    bool operator==(const Position &o) const {
+        if (!sameGeometry(o)) {
+            return false;
+        }
+        for (int i = 0; i < Bitboard::WORDS; i++) {
+            if (stones[0].w[i] != o.stones[0].w[i] || stones[1].w[i] != o.stones[1].w[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+    // zobrist key of the board, the search updates it incrementally with zobrist() along the moves it plays
+    uint64_t hash() const {
+        uint64_t key = zobrist(2, bit(noX, noY));
+        for (int b = 0; b < Bitboard::WORDS * 64; b++) {
+            if (stones[0].test(b)) {
+                key ^= zobrist(0, b);
+            } else if (stones[1].test(b)) {
+                key ^= zobrist(1, b);
+            }
+        }
+        return key;
+    }
+    // drop a stone of the given player into column y and return its row
+    int play(int y, bool ai) {
+        int x = --top[y];
+        int b = bit(x, y);
+        stones[ai].set(b);
+        // the spot above is banned, skip it
+        if (blocked.test(b + 1)) {
+            top[y]--;
+        }
+        if (!top[y]) {
+            legal &= ~(1 << y);
+        }
+        empty--;
+        return x;
+    }
+    // spots where a stone of the player would complete four in a row, occupied and off-board spots included
+    // the guard bits between the columns keep the lines from wrapping around
+    Bitboard threats(bool ai) const {
+        const Bitboard &s = stones[ai];
+        Bitboard r = (s << 1) & (s << 2) & (s << 3); // vertical, only from below
+        static const int dirs[3] = {STRIDE, STRIDE - 1, STRIDE + 1};
+        for (int d : dirs) {
+            Bitboard p = (s << d) & (s << (2 * d)); // two stones on one side
+            r = r | (p & (s << (3 * d))) | (p & (s >> d));
+            p = (s >> d) & (s >> (2 * d)); // two stones on the other side
+            r = r | (p & (s << d)) | (p & (s >> (3 * d)));
+        }
+        return r;
+    }
+    // the spots no stone has reached yet, the banned spot excluded
+    Bitboard emptySpots() const {
+        Bitboard r;
+        for (int y = 0; y < w; y++) {
+            uint64_t column = (((uint64_t)1 << top[y]) - 1) << (h - top[y]); // rows [0, top[y])
+            int offset = y * STRIDE;
+            r.w[offset >> 6] |= column << (offset & 63);
+            if ((offset & 63) + h > 64) { // the column straddles two words
+                r.w[(offset >> 6) + 1] |= column >> (64 - (offset & 63));
+            }
+        }
+        return r & ~blocked;
+    }
+    // the spots the next stone of each column would land on
+    Bitboard playable() const {
+        Bitboard r;
+        for (int y = 0; y < w; y++) {
+            if (top[y] > 0) {
+                r.set(bit(top[y] - 1, y));
+            }
+        }
+        return r;
+    }
+    // the spots of the rows with the given parity, counted from the bottom row (parity 0)
+    static const Bitboard& rows(int parity) {
+        static const Bitboard masks[2] = {rowMask(0), rowMask(1)};
+        return masks[parity];
+    }
+    // whether the player has four in a row anywhere on the board
+    bool isWin(bool ai) const {
+        const Bitboard &s = stones[ai];
+        static const int dirs[4] = {1, STRIDE, STRIDE - 1, STRIDE + 1}; // vertical, horizontal, two diagonals
+        for (int d : dirs) {
+            Bitboard m = s & (s >> d);
+            if ((m & (m >> (2 * d))).any()) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    static Bitboard rowMask(int parity) {
+        Bitboard r;
+        for (int y = 0; y < w; y++) {
+            for (int x = h - 1 - parity; x >= 0; x -= 2) {
+                r.set(bit(x, y));
+            }
+        }
+        return r;
+    }
+};
@@ -0,0 +1,86 @@
+#pragma once
+#include"Position.h"
+#include<cstdint>
+
+/**
+ * xoshiro128** pseudo random number generator
+ * small and fast, every search thread owns one so the rollouts never share state
+ */
+class Random {
+private:
+    uint32_t s[4];
+
+    static uint32_t rotl(uint32_t x, int k) {
+        return (x << k) | (x >> (32 - k));
+    }
+
+public:
+    Random(uint64_t seed = 1) {
+        this->seed(seed);
+    }
+    // fill the state with splitmix64, so that close seeds give unrelated sequences
+    void seed(uint64_t seed) {
+        for (int i = 0; i < 4; i += 2) {
+            uint64_t z = (seed += 0x9E3779B97F4A7C15ULL);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            z ^= z >> 31;
+            s[i] = (uint32_t)z;
+            s[i + 1] = (uint32_t)(z >> 32);
+        }
+    }
+    uint32_t next() {
+        uint32_t result = rotl(s[1] * 5, 7) * 9;
+        uint32_t t = s[1] << 9;
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = rotl(s[3], 11);
+        return result;
+    }
+    // uniform in [0, n), by multiplication instead of modulo
+    uint32_t below(uint32_t n) {
+        return (uint32_t)(((uint64_t)next() * n) >> 32);
+    }
+};
+
+/**
+ * picks a column among the legal ones with probability proportional to its weight
+ * for every set of legal columns (a mask as in Position::legal) the weighted columns are laid out in a table,
+ * so a pick is one random number and one lookup however many columns are full
+ */
+class ColumnSampler {
+private:
+    static const int MAX_TOTAL = 48; // weights of a row of at most 12 columns growing towards the center
+    uint8_t table[1 << MAX_SIZE][MAX_TOTAL];
+    uint8_t total[1 << MAX_SIZE]; // sum of the weights of the legal columns
+    int width; // number of columns the table was built for, 0 if none
+
+public:
+    ColumnSampler() : width(0) {}
+
+    // weights[i] is the weight of column i, they must add up to at most MAX_TOTAL
+    void build(const int *weights, int w) {
+        for (int mask = 0; mask < (1 << w); mask++) {
+            int k = 0;
+            for (int i = 0; i < w; i++) {
+                if (mask >> i & 1) {
+                    for (int j = 0; j < weights[i]; j++) {
+                        table[mask][k++] = i;
+                    }
+                }
+            }
+            total[mask] = k;
+        }
+        width = w;
+    }
+    bool builtFor(int w) const {
+        return width == w;
+    }
+    // legal must not be empty
+    int pick(uint16_t legal, Random &rng) const {
+        return table[legal][rng.below(total[legal])];
+    }
+};
@@ -0,0 +1,82 @@
+#include"Board.h"
+#include"UCT.h"
+#include<cstdint>
+#include<cstdio>
+#include<vector>
+
+/**
+ * checks of the tree search, built and run by `make test`
+ * a position the search proves lost has to be answered at once, not after the whole time budget
+ * usage: searchtest
+ */
+
+const int LOST_POSITIONS = 5; // lost 9x9 positions searched by the check
+const uint64_t SOLVER_NODES = 20000; // nodes the solver gets to prove that a candidate position is lost
+// iterations a lost position may take, the search is proven long before and checks it every 16 * CHECK_INTERVAL
+// (counted instead of timed, so that a loaded machine does not fail the check)
+const uint64_t MAX_ITERATIONS = 32 * 16 * CHECK_INTERVAL;
+
+typedef Solver<9, 9> Solver9;
+typedef Position<9, 9> Position9;
+
+// whether a stone of the ai in some column gives the user a win on top of it,
+// the search leaves such columns out of the root and never proves them
+static bool undercut(const Board &board) {
+    for (int y = 0; y < board.w; y++) {
+        Board next = board;
+        if (board.top[y] > 1 && !next.play(y, true) && next.canPlay(y) && next.play(y, false)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// random 9x9 games, the ai to move in a position without a win in one for either player,
+// with a column the search leaves out, that the solver quickly proves lost for the ai
+static std::vector<Board> lostPositions() {
+    std::vector<Board> found;
+    Solver9 solver;
+    GameRandom random(1);
+    while ((int)found.size() < LOST_POSITIONS) {
+        Board board(9, 9, 0, 0);
+        bool lost = randomGame(board, random, [&board, &solver](bool ai) {
+            int move;
+            return ai && !board.threatened() && undercut(board)
+                && solver.solve(Position9(board.cells.data(), board.top.data(), board.noX, board.noY), 1, SOLVER_NODES, move) == -1;
+        });
+        if (lost) {
+            found.push_back(board);
+        }
+    }
+    return found;
+}
+
+// the search of a lost position stops once its root is proven
+static bool lostReturnsAtOnce() {
+    std::vector<Board> positions = lostPositions();
+    bool ok = true;
+    for (size_t i = 0; i < positions.size(); i++) {
+        SearchConfig config(false); // on the clock, where the search decides when to stop
+        config.threads = 1;
+        config.solver_empty = 0; // the tree search has to prove it
+        config.stats = true;
+        config.resolve();
+        UCT<9, 9> uct(config);
+        const Board &board = positions[i];
+        uct.move(board.cells.data(), board.top.data(), board.noX, board.noY, -1, -1);
+        const SearchStats &stats = uct.lastStats();
+        if (stats.iterations > MAX_ITERATIONS) {
+            printf("lost position %d: searched %llu iterations in %.2f s, expected at most %llu\n",
+                   (int)i, (unsigned long long)stats.iterations, stats.seconds, (unsigned long long)MAX_ITERATIONS);
+            ok = false;
+        }
+    }
+    printf("lost positions: %d searched\n", (int)positions.size());
+    return ok;
+}
+
+int main() {
+    bool ok = lostReturnsAtOnce();
+    printf(ok ? "search checks passed\n" : "search checks FAILED\n");
+    return ok ? 0 : 1;
+}
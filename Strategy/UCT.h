@@ -1,243 +1,1056 @@
 #pragma once
-#include"UCTNode.h"
-#include<ctime>
+#include"NodePool.h"
+#include"TransTable.h"
+#include"Solver.h"
+#include"Batch.h"
+#include"Config.h"
+#include"Random.h"
+#include"Stats.h"
+#include"TimeManager.h"
+#include<chrono>
 #include<cmath>
+#include<condition_variable>
+#include<cstdio>
 #include<cstdlib>
 #include<cstring>
+#include<mutex>
 #include<utility>
-#include<iostream>
+#include<thread>
+#include<vector>
 
-const double TIME_LIMIT = 1.65 * CLOCKS_PER_SEC;
-const int ITER_LIMIT = 1000000;
 const double COEFF = 0.8;
+const double RAVE_EQUIV = 500; // visits at which the real mean and the RAVE mean of a child weigh about the same
+const int PRIOR_VISITS = 8; // virtual visits a new child starts with, their mean comes from the static prior
+const double PRIOR_RANGE = 0.4; // mean of the virtual visits of the best rated moves
+const double WIDEN_BASE = 2; // children a node may claim before its first visit (progressive widening)
+const double WIDEN_RATE = 0.5; // further children per square root of the visits
+const int VIRTUAL_LOSS = 1; // losses added to a node while a thread of a shared tree is simulating below it
+const int MAX_DEPTH = MAX_SIZE * MAX_SIZE + 1; // longest possible path from the root
+
+/**
+ * what getPoint needs of a search, one UCT is compiled for every board size and
+ * getPoint picks the one for the board from a table of createSearch<H, W>
+ */
+class Search {
+public:
+    virtual ~Search() {}
+    // the move for the board of a call to getPoint, the search lives across the calls of a game
+    virtual std::pair<int, int> move(const int *board, const int *top, int noX, int noY, int lastX, int lastY) = 0;
+};
+
+// one search tree, the root-parallel search keeps one per thread, the tree-parallel search a single shared one
+// once the pool is full, the threads of the tree meet and one of them prunes the tree into the other pool
+struct SearchTree {
+    NodePool first, second; // storage of the tree, the other pool receives the subtree kept for the next move
+    NodePool *pool; // pool holding the current tree
+    UCTNode *root;
+    TransTable table; // positions of the tree, turns it into a DAG
+    std::atomic<bool> full; // an allocation failed, the threads are to stop for a pruning
+    std::mutex lock; // guards the fields below, and the pool while it is pruned
+    std::condition_variable pruned; // signalled when a pruning is over
+    int searching; // threads searching the tree
+    int waiting; // threads waiting for the pruning
+    uint32_t prunings; // number of prunings so far
+
+    SearchTree(uint32_t capacity, bool rave, size_t table_bytes)
+        : first(capacity, rave), second(capacity, rave), pool(&first), root(nullptr), table(table_bytes),
+          full(false), searching(0), waiting(0), prunings(0) {}
+    // the node holding the statistics of slot
+    UCTNode* resolve(UCTNode *slot) {
+        uint32_t first = slot->children.load(std::memory_order_acquire);
+        return UCTNode::isLink(first) ? &(*pool)[first & ~UCTNode::LINK] : slot;
+    }
+    NodePool* spare() {
+        return pool == &first ? &second : &first;
+    }
+};
+
+// state of one search thread
+template<int H, int W>
+struct Worker {
+    SearchTree *tree; // tree the thread searches
+    Position<H, W> current; // scratch board, replayed from the root on every iteration
+    uint64_t key; // zobrist key of current, maintained during the descent only
+    UCTNode* path[MAX_DEPTH]; // nodes visited in the current iteration, starting from the root
+    int depth; // length of path
+    int weight; // number of rollouts behind the result of the current iteration
+    Random rng; // the thread's random number generator
+    SearchStats stats; // counters of the current search
+    uint64_t budget; // iterations to run when the search has a fixed number of them (SearchConfig::iterations)
+};
 
 // upper confidence tree
-class UCT {
+// with several threads either every thread searches its own tree from the same root (root parallelization)
+// and the statistics of the root children are merged to pick the move,
+// or all threads search one shared tree and virtual losses spread them over different paths (tree parallelization)
+// the search is compiled for every board size, so the board geometry is known at compile time
+template<int H, int W>
+class UCT : public Search {
 private:
-    UCTNode *root;
-    int h, w; // height and width of the board
+    typedef ::Position<H, W> Position;
+    typedef typename Position::Bitboard Bitboard;
+    typedef ::Worker<H, W> Worker;
+    typedef ::Solver<H, W> Solver;
+    static const int h = H, w = W; // height and width of the board
+
+    SearchConfig config;
+    std::vector<SearchTree*> trees; // one per thread
+    std::vector<Worker> workers; // one per thread, kept across searches instead of being allocated on every move
+    std::vector<std::thread> threads; // the helper threads of the current search
+    Position root_pos; // board at the root
+    uint64_t root_key; // zobrist key of root_pos
     int noX, noY; // banned spot
-    clock_t start_time; // starting time
-    int* position_pd; // probability distribution of positions
-    int total_pd; // sum of position_pd
+    TimeManager timer; // budget of the current move
+    std::atomic<bool> stop; // the main thread decided the search is over, or the next move ends the pondering
+    uint64_t start_visits; // visits of the root children when the search started
+    int position_pd[MAX_SIZE]; // probability distribution of positions
+    ColumnSampler sampler; // draws rollout moves according to position_pd
+    Solver solver; // exact endgame search
+    int played_y; // column of the move returned by the last search, -1 if none
+    bool pondered; // the trees and root_pos went on to the position after played_y to search on the opponent's time
+    bool pondering; // the workers search without a clock until stop is set
+    std::thread ponderer; // runs the workers between two moves
+    uint64_t ponder_iterations; // iterations searched on the opponent's time before the last move, counted with stats on
+    bool shared; // several threads search the same tree
+    SearchStats stats; // counters of the last search, added up over the threads
+    FILE *stats_file; // where the statistics of every move go, nullptr if they are off
 
 public:
-    UCT(int **_board, int _h, int _w, const int *_top, int _noX, int _noY, int _lastX, int _lastY) : h(_h), w(_w), noX(_noX), noY(_noY) {
-        root = new UCTNode(_board, _h, _w, _top, noX, noY, _lastX, _lastY);
-        start_time = clock();
+    explicit UCT(const SearchConfig &_config = SearchConfig()) : config(_config), workers(config.threads), played_y(-1), pondered(false), pondering(false),
+                                                            ponder_iterations(0), shared(config.tree_parallel && config.threads > 1) {
+        // the trees share the memory budget, each tree splits its part between its two pools
+        int tree_count = config.tree_parallel ? 1 : config.threads;
+        size_t node_bytes = sizeof(UCTNode) + (config.rave ? sizeof(AmafStats) : 0);
+        size_t capacity = ((size_t)config.memory_mb << 20) / tree_count / 2 / node_bytes;
+        if (capacity >= UCTNode::LINK) { // pool indices have to stay below the link flag
+            capacity = UCTNode::LINK - 1;
+        }
+        for (int i = 0; i < tree_count; i++) {
+            trees.push_back(new SearchTree(capacity, config.rave, ((size_t)config.table_mb << 20) / tree_count));
+        }
+        for (size_t i = 0; i < workers.size(); i++) {
+            workers[i].tree = trees[i % trees.size()];
+        }
+        threads.reserve(workers.size());
+        stats_file = config.stats_file.empty() ? nullptr : fopen(config.stats_file.c_str(), "a");
+    }
+    ~UCT() {
+        stopPondering();
+        for (SearchTree *tree : trees) {
+            delete tree;
+        }
+        if (stats_file) {
+            fclose(stats_file);
+        }
+    }
+
+    // counters of the last move, the phases are only timed with SearchConfig::stats on
+    const SearchStats& lastStats() const {
+        return stats;
+    }
+
+    std::pair<int, int> move(const int *board, const int *top, int noX, int noY, int lastX, int lastY) override {
+        setRoot(board, top, noX, noY, lastX, lastY);
+        stats.clear();
+        std::pair<int, int> result;
+        bool solved = solve(result); // few spots left: exact endgame solver
+        if (!solved) {
+            result = search();
+        }
+        if (stats_file) {
+            report(result, solved);
+        }
+        if (config.ponder) {
+            startPondering();
+        }
+        return result;
+    }
+
+    // set up the root for a new call to getPoint
+    // if the board is the one of the last search followed by our move and the opponent's reply,
+    // the matching grandchild becomes the new root and keeps its statistics, otherwise a fresh tree is built
+    // (after pondering the trees are already rooted after our move, and the matching child is taken)
+    void setRoot(const int *_board, const int *_top, int _noX, int _noY, int _lastX, int _lastY) {
+        timer.start();
+        stopPondering();
+        Position next(_board, _top, _noX, _noY);
+
+        bool follows = false; // whether next continues the game of the last search
+        if (played_y != -1 && _lastY != -1) {
+            Position expected = root_pos;
+            if (expected.sameGeometry(next) && (pondered || expected.canPlay(played_y))) {
+                if (!pondered) {
+                    expected.play(played_y, true);
+                }
+                if (expected.canPlay(_lastY)) {
+                    expected.play(_lastY, false);
+                    follows = expected == next;
+                }
+            }
+        }
+
+        for (SearchTree *tree : trees) {
+            uint32_t reused = NodePool::NONE;
+            if (follows) {
+                uint32_t child = pondered ? 0 : findChild(*tree, tree->root, played_y);
+                if (child != NodePool::NONE) {
+                    reused = findChild(*tree, &(*tree->pool)[child], _lastY);
+                }
+            }
+            reroot(*tree, reused, _lastX, _lastY, true);
+        }
+
+        root_pos = next;
+        root_key = next.hash();
+        played_y = -1;
+        pondered = false;
+        timer.plan(root_pos);
+        noX = _noX;
+        noY = _noY;
 
         // set the distribution of weights
-        position_pd = new int[w];
-        int mid = (w - 1) / 2;
+        if (!sampler.builtFor(w)) {
+            int mid = (w - 1) / 2;
 
-        int i = 0;
-        while (i <= mid) {
-            position_pd[i] = i + 1;
-            i++;
+            int i = 0;
+            while (i <= mid) {
+                position_pd[i] = i + 1;
+                i++;
+            }
+            while (i < w) {
+                position_pd[i] = position_pd[w-i-1];
+                i++;
+            }
+            sampler.build(position_pd, w);
         }
-        total_pd = i * (i + 1);
-        if (w % 2) {
-            total_pd -= i;
+    }
+
+    // make node the root of tree, a fresh root for the move (x, y) if node is NONE
+    static void reroot(SearchTree &tree, uint32_t node, int x, int y, bool ai_turn) {
+        if (node != NodePool::NONE) {
+            // move the subtree into the other pool, this releases the rest of the old tree
+            NodePool *spare = tree.spare();
+            spare->reset();
+            copyTree(*tree.pool, node, *spare);
+            tree.pool = spare;
+        } else {
+            tree.pool->reset(); // drop the tree of the previous search
+            (*tree.pool)[tree.pool->allocate(1)].init(x, y, ai_turn);
+        }
+        tree.root = &(*tree.pool)[0];
+        tree.table.clear(); // the nodes moved
+        tree.full.store(false, std::memory_order_relaxed);
+    }
+
+    // keep searching while the opponent thinks: the trees go on to the position after our move,
+    // where the opponent is to move, and the workers search it on a thread of their own until the next move
+    // stops them; the next setRoot then takes the subtree of the opponent's reply as usual
+    void startPondering() {
+        Position next = root_pos;
+        int x = next.play(played_y, true);
+        if (next.isWin(true) || next.isFull()) { // the game is over
+            return;
         }
-        while (i < w) {
-            position_pd[i] = position_pd[w-i-1];
-            i++;
+        for (SearchTree *tree : trees) {
+            reroot(*tree, findChild(*tree, tree->root, played_y), x, played_y, false);
         }
+        root_pos = next;
+        root_key = next.hash();
+        pondered = true;
+        pondering = true;
+        stop.store(false);
+        ponderer = std::thread(&UCT::runWorkers, this);
     }
-    ~UCT() {
-        delete[] position_pd;
-        delete root;
+
+    void stopPondering() {
+        ponder_iterations = 0;
+        if (!ponderer.joinable()) {
+            return;
+        }
+        stop.store(true);
+        ponderer.join();
+        pondering = false;
+        for (Worker &worker : workers) {
+            ponder_iterations += worker.stats.iterations;
+        }
+    }
+
+    // play the endgame exactly when few spots are left
+    // the solver gets a share of the move budget, if it cannot prove a win or a draw in time
+    // (or proves a loss, where the tree search plays on for the opponent's mistakes) it returns false
+    // on a fixed number of iterations it gets nodes instead of time, so that it gives up at the same point every run
+    bool solve(std::pair<int, int> &result) {
+        if (root_pos.empty > config.solver_empty) {
+            return false;
+        }
+        int move;
+        uint64_t nodes = (uint64_t)config.iterations * SOLVER_NODES_PER_ITERATION;
+        int value = solver.solve(root_pos, timer.remaining() * SOLVER_SHARE, nodes, move);
+        if (value == Solver::UNKNOWN || value < 0) {
+            return false;
+        }
+        played_y = move;
+        timer.finish();
+        result = std::pair<int, int>(root_pos.top[move] - 1, move);
+        return true;
     }
 
     //perform UCT search
     std::pair<int, int> search() {
         //next move ai can win
         for (int i = 0; i < w; i++) {
-            if (root->top[i] > 0) {
-                int row = root->top[i] - 1;
-                root->board[row][i] = 2;
-                if (machineWin(row, i, h, w, root->board)) {
-                    root->board[row][i] = 0;
+            if (root_pos.canPlay(i)) {
+                Position next = root_pos;
+                int row = next.play(i, true);
+                if (next.isWin(true)) {
+                    played_y = i;
+                    timer.finish();
                     return std::pair<int, int>(row, i);
                 }
-                root->board[row][i] = 0;
             }
         }
         //next move user can win
         for (int i = 0; i < w; i++) {
-            if (root->top[i] > 0) {
-                int row = root->top[i] - 1;
-                root->board[row][i] = 1;
-                if (userWin(row, i, h, w, root->board)) {
-                    root->board[row][i] = 0;
+            if (root_pos.canPlay(i)) {
+                Position next = root_pos;
+                int row = next.play(i, false);
+                if (next.isWin(false)) {
+                    played_y = i;
+                    timer.finish();
                     return std::pair<int, int>(row, i);
                 }
-                root->board[row][i] = 0;
             }
         }
 
-        //keep track of the memory limit by keeping track of the iterations
-        int iter = 0;
-        while ((clock() - start_time < TIME_LIMIT) && (++iter < ITER_LIMIT)) {
-            UCTNode *selected_node = treePolicy(); // selection and expansion
-            double result = defaultPolicy(selected_node);// simulation
-            backpropagate(selected_node, result);// backpropagation
+        //only one move is possible
+        if (!(root_pos.legal & (root_pos.legal - 1))) {
+            for (played_y = 0; !root_pos.canPlay(played_y); played_y++);
+            timer.finish();
+            return std::pair<int, int>(root_pos.top[played_y] - 1, played_y);
         }
+
+        // the calling thread runs the first worker
+        stop.store(false);
+        start_visits = 0;
+        uint32_t visits[MAX_SIZE];
+        int32_t profit[MAX_SIZE];
+        int8_t proof[MAX_SIZE];
+        rootStats(visits, profit, proof);
+        for (int i = 0; i < w; i++) {
+            start_visits += visits[i];
+        }
+        double started = timer.elapsed();
+        runWorkers();
+        stats.seconds = timer.elapsed() - started;
+        for (Worker &worker : workers) {
+            stats.add(worker.stats);
+        }
+
         // return the move to the best child
-        UCTNode* best = bestMove();
-        return std::pair<int, int>(best->move_x, best->move_y);
+        played_y = bestMove();
+        timer.finish();
+        return std::pair<int, int>(root_pos.top[played_y] - 1, played_y);
+    }
+
+    // run every worker on its tree until the search is over, the calling thread runs the first one
+    void runWorkers() {
+        for (size_t i = 0; i < workers.size(); i++) {
+            // with a seed the threads draw the same numbers on every run of the same game
+            workers[i].rng.seed(config.deterministic ? ((uint64_t)config.seed << 32 ^ root_key) + i : (uint64_t)rand() << 32 | i);
+            workers[i].tree->searching++;
+            workers[i].stats.clear();
+            workers[i].budget = config.iterations / workers.size() + (i < config.iterations % workers.size());
+        }
+        void (UCT::*loop)(Worker&, bool) = config.stats ? &UCT::run<true> : &UCT::run<false>;
+        for (size_t i = 1; i < workers.size(); i++) {
+            threads.push_back(std::thread(loop, this, std::ref(workers[i]), false));
+        }
+        (this->*loop)(workers[0], true);
+        for (std::thread &thread : threads) {
+            thread.join();
+        }
+        threads.clear();
+    }
+
+    // the search loop of one thread, the main thread also checks whether the move is already decided
+    // with a fixed number of iterations the thread runs its share of them, whatever the clock says,
+    // while pondering it runs until stop is set
+    // with STATS the iterations are counted and their phases timed
+    template<bool STATS>
+    void run(Worker &t, bool main) {
+        typedef std::chrono::steady_clock Clock;
+        Clock::time_point mark;
+        for (uint64_t iter = 1; ; iter++) {
+            if (t.tree->full.load(std::memory_order_relaxed)) {
+                meet(*t.tree, false);
+            }
+            if (config.iterations) {
+                if (iter > t.budget) {
+                    break;
+                }
+            } else if (iter % CHECK_INTERVAL == 0) {
+                if (stop.load(std::memory_order_relaxed) || (!pondering && timer.expired())) {
+                    break;
+                }
+                if (main && !pondering && iter % (16 * CHECK_INTERVAL) == 0 && decided()) {
+                    stop.store(true, std::memory_order_relaxed);
+                    break;
+                }
+            }
+            if (STATS) {
+                mark = Clock::now();
+            }
+            UCTNode *selected_node = treePolicy(t); // selection and expansion
+            if (STATS) {
+                t.stats.tree_policy += lap(mark);
+            }
+            int result = defaultPolicy(t, selected_node);// simulation, sets t.weight
+            if (STATS) {
+                t.stats.default_policy += lap(mark);
+            }
+            backpropagate(t, result);// backpropagation
+            if (STATS) {
+                t.stats.backpropagate += lap(mark);
+                t.stats.iterations++;
+                t.stats.playouts += t.weight;
+                t.stats.depth_sum += t.depth - 1;
+                if (t.depth - 1 > t.stats.max_depth) {
+                    t.stats.max_depth = t.depth - 1;
+                }
+            }
+        }
+        meet(*t.tree, true);
+    }
+
+    // seconds since mark, which moves to now
+    static double lap(std::chrono::steady_clock::time_point &mark) {
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        double seconds = std::chrono::duration<double>(now - mark).count();
+        mark = now;
+        return seconds;
+    }
+
+    // append the statistics of the move to the stats file as one JSON object
+    // source tells who chose the move: the endgame solver, or the tree search (which may return at once)
+    void report(std::pair<int, int> result, bool solved) {
+        uint32_t visits[MAX_SIZE];
+        int32_t profit[MAX_SIZE];
+        int8_t proof[MAX_SIZE];
+        rootStats(visits, profit, proof);
+        uint32_t nodes = 0;
+        for (SearchTree *tree : trees) {
+            nodes += tree->pool->used();
+        }
+        fprintf(stats_file, "{\"h\": %d, \"w\": %d, \"empty\": %d, \"x\": %d, \"y\": %d, \"source\": \"%s\", "
+                "\"time\": %.4f, \"search_time\": %.4f, \"iterations\": %llu, \"ponder_iterations\": %llu, "
+                "\"playouts\": %llu, \"playouts_per_sec\": %.0f, \"nodes_allocated\": %llu, \"nodes\": %u, "
+                "\"max_depth\": %d, \"avg_depth\": %.2f, "
+                "\"tree_policy\": %.4f, \"default_policy\": %.4f, \"backpropagate\": %.4f, \"root_visits\": [",
+                h, w, root_pos.empty, result.first, result.second, solved ? "solver" : "search",
+                timer.elapsed(), stats.seconds, (unsigned long long)stats.iterations, (unsigned long long)ponder_iterations,
+                (unsigned long long)stats.playouts,
+                stats.seconds > 0 ? stats.playouts / stats.seconds : 0.0, (unsigned long long)stats.nodes, nodes,
+                stats.max_depth, stats.iterations ? stats.depth_sum / (double)stats.iterations : 0.0,
+                stats.tree_policy, stats.default_policy, stats.backpropagate);
+        for (int i = 0; i < w; i++) {
+            fprintf(stats_file, i ? ", %u" : "%u", visits[i]);
+        }
+        fprintf(stats_file, "]}\n");
+        fflush(stats_file);
+    }
+
+    // a thread found its tree full (arriving) or stops searching it (leaving)
+    // the threads of the tree wait for each other, the last one the others were waiting for prunes the tree
+    void meet(SearchTree &tree, bool leaving) {
+        std::unique_lock<std::mutex> guard(tree.lock);
+        if (leaving) {
+            tree.searching--;
+        } else if (tree.full.load(std::memory_order_relaxed)) {
+            tree.waiting++;
+        } else { // pruned in the meantime
+            return;
+        }
+        if (tree.waiting && tree.waiting == tree.searching) {
+            prune(tree);
+            tree.waiting = 0;
+            tree.prunings++;
+            tree.full.store(false, std::memory_order_relaxed);
+            tree.pruned.notify_all();
+        } else if (!leaving) {
+            uint32_t prunings = tree.prunings;
+            tree.pruned.wait(guard, [&tree, prunings] { return tree.prunings != prunings; });
+        }
+    }
+
+    // make room in a full tree: nodes visited less than a threshold lose their children,
+    // the threshold is the lowest power of two that keeps at most half of the pool,
+    // and the rest of the tree is copied into the other pool
+    void prune(SearchTree &tree) {
+        NodePool &pool = *tree.pool;
+        uint64_t children[33] = {}; // children[k]: children of the nodes with visits in [2^(k-1), 2^k)
+        for (uint32_t i = 0; i < pool.used(); i++) {
+            uint32_t first = pool[i].children.load(std::memory_order_relaxed);
+            if (first && first < UCTNode::LINK) {
+                uint32_t visits = pool[i].visit_count.load(std::memory_order_relaxed);
+                children[visits ? 32 - __builtin_clz(visits) : 0] += pool[i].child_count;
+            }
+        }
+        uint64_t kept = 0;
+        int k = 32;
+        while (k >= 0 && kept + children[k] <= pool.limit() / 2) {
+            kept += children[k--];
+        }
+        uint32_t min_visits = k < 0 ? 0 : k == 32 ? UINT32_MAX : (uint32_t)1 << k;
+
+        NodePool *spare = tree.spare();
+        spare->reset();
+        copyTree(pool, 0, *spare, min_visits);
+        tree.pool = spare;
+        tree.root = &(*spare)[0];
+        tree.table.clear(); // the nodes moved
     }
 
-    UCTNode* treePolicy() {
-        UCTNode* curr = root;
+    // whether the move bestMove would pick is also the most visited one,
+    // and leads by more visits than the search can still make in the remaining time
+    // or whether the search already proved the root, or that no other move avoids a loss
+    bool decided() {
+        for (SearchTree *tree : trees) {
+            std::lock_guard<std::mutex> guard(tree->lock); // its own thread may be pruning it
+            if (tree->root->proof.load(std::memory_order_relaxed)) {
+                return true;
+            }
+        }
+        uint32_t visits[MAX_SIZE];
+        int32_t profit[MAX_SIZE];
+        int8_t proof[MAX_SIZE];
+        rootStats(visits, profit, proof);
+        int best = bestMove();
+        int moves[MAX_SIZE];
+        int count = forcedMoves(root_pos, true, moves); // the children of the root, the other moves are never searched
+        int open = 0; // moves not proven to lose
+        for (int i = 0; i < count; i++) {
+            open += proof[moves[i]] != UCTNode::PROVEN_USER;
+        }
+        if (proof[best] == UCTNode::PROVEN_AI || open <= 1) {
+            return true;
+        }
+        uint64_t total = 0;
+        uint32_t runner_up = 0;
+        for (int i = 0; i < w; i++) {
+            total += visits[i];
+            if (i != best && visits[i] > runner_up) {
+                runner_up = visits[i];
+            }
+        }
+        double rate = (total - start_visits) / timer.elapsed(); // visits per second
+        return visits[best] > runner_up + rate * timer.remaining();
+    }
+
+    // descend from the root, playing the moves on current along the way
+    UCTNode* treePolicy(Worker &t) {
+        UCTNode* curr = t.tree->root;
+        t.current = root_pos;
+        t.key = root_key;
+        t.depth = 0;
+        t.path[t.depth++] = curr;
         while (!curr->isTerminal()) {
-            if (curr->expandable()) {
-                return expand(curr);
-            } else {
-                curr = bestChild(curr);
+            if (curr->expandable() && widened(curr)) {
+                UCTNode *child = expand(t, curr);
+                if (child) {
+                    return child;
+                }
+                // other threads claimed the remaining children in the meantime, select among them
+            }
+            bool ai_turn = curr->ai_turn;
+            UCTNode *slot = bestChild(*t.tree, curr);
+            if (!slot) { // every claimed child loses, claim another one whatever the widening says
+                UCTNode *child = expand(t, curr);
+                if (child) {
+                    return child;
+                }
+                slot = bestChild(*t.tree, curr);
             }
+            play(t, slot, ai_turn);
+            curr = t.tree->resolve(slot);
+            visit(t, curr);
         }
         return curr;
     }
 
+    // progressive widening: whether node has enough visits to claim one more child
+    // nodes without children pass, so that they get allocated
+    static bool widened(UCTNode *node) {
+        double visits = node->visit_count.load(std::memory_order_relaxed);
+        return node->expanded_count.load(std::memory_order_relaxed) < WIDEN_BASE + WIDEN_RATE * sqrt(visits);
+    }
+
+    // apply the move of slot to the board of the worker
+    void play(Worker &t, UCTNode *slot, bool ai_turn) {
+        t.current.play(slot->move_y, ai_turn);
+        t.key ^= zobrist(ai_turn, t.current.bit(slot->move_x, slot->move_y));
+    }
+
+    // append node to the path, in a shared tree it also gets a virtual loss for the player who moved into it
+    void visit(Worker &t, UCTNode *node) {
+        t.path[t.depth++] = node;
+        if (shared) {
+            node->visit_count.fetch_add(VIRTUAL_LOSS, std::memory_order_relaxed);
+            node->profit.fetch_add(node->ai_turn ? VIRTUAL_LOSS : -VIRTUAL_LOSS, std::memory_order_relaxed);
+        }
+    }
+
     // add one expandable node as a child of the current node
-    // we randomly choose one from all the possible moves
-    UCTNode* expand(UCTNode *node) {
-        // choose one move and create a node for it
-        int chosen_rank = rand() % node->expandable_count;
-        int *new_top = new int[w];
-        memcpy(new_top, node->top, sizeof(int) * w);
+    // the children are put in random order when the node is expanded for the first time,
+    // every expansion then claims the next one, so threads sharing the tree never expand the same child
+    // returns node itself if it has to stay a leaf for now, nullptr if all children were claimed
+    UCTNode* expand(Worker &t, UCTNode *node) {
+        uint32_t first = node->children.load(std::memory_order_acquire);
+        if (!first && node->children.compare_exchange_strong(first, UCTNode::BUSY, std::memory_order_acquire)) {
+            first = allocateChildren(t, node);
+        }
+        if (first >= UCTNode::LINK) { // another thread is creating the children, out of memory, or a link made by another thread
+            return node;
+        }
+
+        int rank = node->expanded_count.fetch_add(1, std::memory_order_relaxed);
+        if (rank >= node->child_count) {
+            return nullptr;
+        }
+        UCTNode *slot = &(*t.tree->pool)[first + rank];
+        play(t, slot, node->ai_turn); // apply the move
+        UCTNode *child = slot->terminal || !t.tree->table.enabled() ? slot : transpose(t, first + rank);
+        visit(t, child);
+
+        return child;
+    }
+
+    // look up the position reached by the newly claimed child at index, current holds it and key its key
+    // a known position turns the child into a link and its node is returned, an unknown one is recorded
+    UCTNode* transpose(Worker &t, uint32_t index) {
+        NodePool &pool = *t.tree->pool;
+        UCTNode *slot = &pool[index];
+        uint32_t known = t.tree->table.find(t.key);
+        if (known == NodePool::NONE) {
+            t.tree->table.insert(t.key, index);
+            return slot;
+        }
+        uint32_t expected = 0;
+        if (pool[known].ai_turn == slot->ai_turn // the check bits of the key are not a full proof
+            && slot->children.compare_exchange_strong(expected, UCTNode::LINK | known, std::memory_order_acq_rel)) {
+            return &pool[known];
+        }
+        return slot; // another thread reached the child first and expands it
+    }
+
+    // reserve a slot for every move of node worth searching and publish them, current is the board at node
+    // returns the index of the first child, NONE if the pool is full
+    uint32_t allocateChildren(Worker &t, UCTNode *node) {
+        NodePool &pool = *t.tree->pool;
+        const Position &current = t.current;
+        int moves[MAX_SIZE];
+        int count = forcedMoves(current, node->ai_turn, moves);
+        // shuffle, so that moves of equal prior are expanded in random order
+        for (int i = count - 1; i > 0; i--) {
+            std::swap(moves[i], moves[t.rng.below(i + 1)]);
+        }
+        // the children are expanded in the order of their priors, best first
+        double prior[MAX_SIZE];
+        priors(current, node->ai_turn, moves, count, prior);
+        for (int i = 1; i < count; i++) {
+            for (int j = i; j > 0 && prior[j] > prior[j - 1]; j--) {
+                std::swap(moves[j], moves[j - 1]);
+                std::swap(prior[j], prior[j - 1]);
+            }
+        }
+
+        uint32_t first = pool.allocate(count);
+        if (first == NodePool::NONE) {
+            node->children.store(0, std::memory_order_release); // let a later visit try again
+            t.tree->full.store(true, std::memory_order_relaxed); // after the tree is pruned
+            return NodePool::NONE;
+        }
+        t.stats.nodes += count;
+        for (int i = 0; i < count; i++) {
+            Position next = current;
+            int x = next.play(moves[i], node->ai_turn);
+            UCTNode &child = pool[first + i];
+            child.init(x, moves[i], !node->ai_turn);
+            if (count > 1) {
+                int value = (int)lround(PRIOR_VISITS * PRIOR_RANGE * prior[i]);
+                child.visit_count.store(PRIOR_VISITS, std::memory_order_relaxed);
+                child.profit.store(node->ai_turn ? value : -value, std::memory_order_relaxed);
+            }
+            bool won = next.isWin(node->ai_turn);
+            child.terminal = won || next.isFull(); // the move won, or the board is full
+            if (won) { // the only child, it proves node on the first expansion
+                child.proof.store(node->ai_turn ? UCTNode::PROVEN_AI : UCTNode::PROVEN_USER, std::memory_order_relaxed);
+            }
+        }
+        node->child_count = count;
+        node->children.store(first, std::memory_order_release);
+        return first;
+    }
 
-        int y = node->expandable_nodes[chosen_rank]; // randomly chosen column
-        int x = --new_top[y]; // fill the corresponding row
+    // static rating in [0, 1] of each move for the player to move at pos
+    // the center is worth a little, new winning spots of the player a lot (more if their row has the parity
+    // that favours the player: odd rows counted from the bottom for whoever moved first, even rows otherwise),
+    // and so are the winning spots the opponent would get from the same spot
+    void priors(const Position &pos, bool ai, const int *moves, int count, double *prior) {
+        if (count < 2) {
+            prior[0] = 0;
+            return;
+        }
+        Bitboard empty = pos.emptySpots();
+        bool first_player = (pos.stones[0].count() + pos.stones[1].count()) % 2 == 0;
+        const Bitboard &parity = Position::rows(first_player ? 0 : 1); // rows that favour the player to move
+        int own_before = (pos.threats(ai) & empty).count();
+        int good_before = (pos.threats(ai) & empty & parity).count();
+        int theirs_before = (pos.threats(!ai) & empty).count();
+        double center = (w - 1) / 2.0;
+        for (int i = 0; i < count; i++) {
+            Position next = pos;
+            next.play(moves[i], ai);
+            Bitboard left = next.emptySpots();
+            Bitboard own = next.threats(ai) & left;
+            int created = own.count() - own_before;
+            int good = (own & parity).count() - good_before;
+            next = pos;
+            next.play(moves[i], !ai);
+            int taken = (next.threats(!ai) & left).count() - theirs_before;
+            double score = 0.5 * (1 - fabs(moves[i] - center) / center) + 0.5 * created + 0.5 * good + 0.75 * taken;
+            prior[i] = score < 2 ? score / 2 : 1;
+        }
+    }
 
-        // check if the next spot in the column is banned
-        if (y == this->noY && x-1 == this->noX) {
-            new_top[y]--;
+    // fill moves with the columns worth searching at pos and return their number
+    // a win in one is the only move, otherwise a winning spot of the opponent has to be blocked
+    // (with two of them the position is lost, one block is enough to prove it),
+    // otherwise every move except those landing right below a winning spot of the opponent,
+    // unless all of them do
+    static int forcedMoves(const Position &pos, bool ai, int *moves) {
+        Bitboard playable = pos.playable();
+        Bitboard losses = pos.threats(!ai); // spots that would win for the opponent
+        Bitboard forced = pos.threats(ai) & playable;
+        if (!forced.any()) {
+            forced = losses & playable;
+        }
+        if (forced.any()) {
+            moves[0] = forced.first() / Position::STRIDE;
+            return 1;
         }
 
-        node->children[y] = new UCTNode(node->board, h, w, new_top, noX, noY, x, y, !node->ai_turn, node); // create the node
-        node->children[y]->board[x][y] = node->ai_turn ? 2 : 1; // apply the move
-        node->removeExpandableNode(chosen_rank);
-        delete[] new_top;
-        
-        return node->children[y];   
+        int count = 0;
+        for (int i = 0; i < pos.w; i++) {
+            if (pos.canPlay(i)) {
+                Position next = pos;
+                next.play(i, ai);
+                if (!next.canPlay(i) || !losses.test(next.bit(next.top[i] - 1, i))) {
+                    moves[count++] = i;
+                }
+            }
+        }
+        if (!count) { // every move gives the opponent a win, search them all
+            for (int i = 0; i < pos.w; i++) {
+                if (pos.canPlay(i)) {
+                    moves[count++] = i;
+                }
+            }
+        }
+        return count;
     }
 
     // find the best child based on UCB
-    UCTNode* bestChild(UCTNode *node) {
+    // children proven to lose for the player to move are skipped, one proven to win is taken at once and proves node
+    // returns nullptr if every claimed child loses while others are left to claim
+    UCTNode* bestChild(SearchTree &tree, UCTNode *node) {
         double best_UCB = -RAND_MAX;
         UCTNode* best = nullptr;
+        UCTNode* lost = nullptr; // taken if every child is lost, until node is proven
 
-        for (int i = 0; i < w; i++) {
-            if (node->children[i]) {
-                // calculate UCB
-                double temp_UCB = (node->ai_turn ? 1 : -1) * node->children[i]->profit / (double)(node->children[i]->visit_count)
-                    + COEFF * sqrt(2 * log((double)(node->visit_count)) / (double)(node->children[i]->visit_count));
-                if (temp_UCB > best_UCB) {
-                    best = node->children[i];
-                    best_UCB = temp_UCB;
+        int8_t win = node->ai_turn ? UCTNode::PROVEN_AI : UCTNode::PROVEN_USER;
+        double log_visits = log((double)(node->visit_count.load(std::memory_order_relaxed)));
+        int expanded = node->expanded();
+        for (int i = 0; i < expanded; i++) {
+            UCTNode *slot = &(*tree.pool)[node->children + i];
+            UCTNode *child = tree.resolve(slot);
+            int8_t proof = child->proof.load(std::memory_order_relaxed);
+            if (proof == win) {
+                node->proof.store(win, std::memory_order_relaxed);
+                return slot;
+            }
+            if (proof == -win) {
+                lost = slot;
+                continue;
+            }
+            double visits = child->visit_count.load(std::memory_order_relaxed);
+            if (visits == 0) { // claimed by another thread that has not reached it yet
+                return slot;
+            }
+            // with RAVE on, blend the mean with the RAVE mean, which counts for less and less as the visits grow
+            double mean = child->profit.load(std::memory_order_relaxed) / visits;
+            if (config.rave) {
+                AmafStats &amaf = tree.pool->amafOf(child);
+                double amaf_visits = amaf.visits.load(std::memory_order_relaxed);
+                if (amaf_visits) {
+                    double beta = sqrt(RAVE_EQUIV / (3 * visits + RAVE_EQUIV));
+                    mean = (1 - beta) * mean + beta * amaf.profit.load(std::memory_order_relaxed) / amaf_visits;
                 }
             }
+            // calculate UCB
+            double temp_UCB = (node->ai_turn ? 1 : -1) * mean + COEFF * sqrt(2 * log_visits / visits);
+            if (temp_UCB > best_UCB) {
+                best = slot;
+                best_UCB = temp_UCB;
+            }
         }
 
-        return best;
+        if (!best && expanded < node->child_count) {
+            return nullptr;
+        }
+        return best ? best : lost;
     }
 
     // perform simulation until a winner is decided
     // starting from node, simulate the game until a result is determined
-    double defaultPolicy(UCTNode *node) {
-        //set up a copy of board and top for simulation
-        int **current_board = new int*[h];
-        for (int i = 0; i < h; i++) {
-            current_board[i] = new int[w];
-            memcpy(current_board[i], node->board[i], sizeof(int) * w);
-        }
-
-        int *current_top = new int[w];
-        memcpy(current_top, node->top, sizeof(int) * w);
-
-        double profit = 0;
-        bool ai_turn = node->ai_turn;
-
-        int last_x = node->move_x;
-        int last_y = node->move_y;
-
- 
-        //keep playing until the game is over
-        while (true) {
-            if (!ai_turn && machineWin(last_x, last_y, h, w, current_board)) { //note: last x and last y is the last round
-                profit = 1;
-                break;
-            } else if (ai_turn && userWin(last_x, last_y, h, w, current_board)) {
-                profit = -1;
-                break;
-            } else if (isTie(w, current_top)) {
-                profit = 0;
-                break;
-            }
-
-            // simulate one turn
-            ai_turn = !ai_turn;
+    // the simulation is played directly on t.current, which holds the board at node
+    // with batches on, BATCH_LANES rollouts are played and the sum of their results is returned,
+    // t.weight tells how many results the returned value adds up
+    int defaultPolicy(Worker &t, UCTNode *node) {
+        t.weight = config.batch ? BATCH_LANES : 1;
+        if (t.current.isWin(!node->ai_turn)) { //note: the player who is not on turn made the last move
+            return (node->ai_turn ? -1 : 1) * t.weight;
+        }
+        if (config.batch) {
+            return BatchRollout<H, W>::run(t.current, node->ai_turn, config.heavy_rollouts, sampler, t.rng);
+        }
+        return config.heavy_rollouts ? heavyRollout(t, node->ai_turn) : lightRollout(t, node->ai_turn);
+    }
 
-            // choose a rank, middle spots have higher probability
-            bool doneSelecting = false;
-            while (!doneSelecting) {
-                int lower_bound = rand() % total_pd;
-                int tmp = 0;
-                for (int i = 0; i < w; ++i) {
-                    tmp += position_pd[i];
-                    if (lower_bound < tmp) {
-                        last_y = i;
-                        break;
-                    }
-                }
-                if (current_top[last_y] > 0) 
-                    doneSelecting = true;
+    // random moves, middle columns are more likely
+    int lightRollout(Worker &t, bool ai_turn) {
+        Position &current = t.current;
+        while (!current.isFull()) {
+            int y = sampler.pick(current.legal, t.rng);
+            current.play(y, ai_turn);
+            if (current.isWin(ai_turn)) {
+                return ai_turn ? 1 : -1;
             }
+            ai_turn = !ai_turn;
+        }
+        return 0;
+    }
 
-            last_x = --current_top[last_y];
+    // win at once if possible, otherwise block the opponent's win, otherwise a random move as in lightRollout
+    // the winning spots of both players and the landing spots are kept move by move: a move only changes
+    // the landing spot of its column and the winning spots of its player, and a win shows up before it is
+    // played, as a landing spot among the winning spots of the player to move, so the board is never scanned for one
+    int heavyRollout(Worker &t, bool ai_turn) {
+        Position &current = t.current;
+        Bitboard threats[2] = {current.threats(false), current.threats(true)};
+        Bitboard playable = current.playable();
+        while (!current.isFull()) {
+            Bitboard win = threats[ai_turn] & playable;
+            if (win.any()) {
+                current.play(win.first() / Position::STRIDE, ai_turn); // played for the RAVE statistics
+                return ai_turn ? 1 : -1;
+            }
+            Bitboard block = threats[!ai_turn] & playable;
+            int y = block.any() ? block.first() / Position::STRIDE : sampler.pick(current.legal, t.rng);
+            int x = current.play(y, ai_turn);
+            playable.clear(current.bit(x, y));
+            if (current.canPlay(y)) {
+                playable.set(current.bit(current.top[y] - 1, y));
+            }
+            threats[ai_turn] = current.threats(ai_turn);
+            ai_turn = !ai_turn;
+        }
+        return 0;
+    }
 
-            current_board[last_x][last_y] = ai_turn? 1 : 2;
+    //update the profit along the path of the current iteration
+    // in a shared tree the virtual losses of the descent are taken back
+    void backpropagate(Worker &t, int profit) {
+        t.path[0]->visit_count.fetch_add(t.weight, std::memory_order_relaxed);
+        t.path[0]->profit.fetch_add(profit, std::memory_order_relaxed);
+        for (int i = 1; i < t.depth; i++) {
+            UCTNode *node = t.path[i];
+            if (shared) {
+                node->visit_count.fetch_add(t.weight - VIRTUAL_LOSS, std::memory_order_relaxed);
+                node->profit.fetch_add(profit - (node->ai_turn ? VIRTUAL_LOSS : -VIRTUAL_LOSS), std::memory_order_relaxed);
+            } else {
+                node->visit_count.fetch_add(t.weight, std::memory_order_relaxed);
+                node->profit.fetch_add(profit, std::memory_order_relaxed);
+            }
+        }
+        if (config.rave) {
+            updateAmaf(t, profit);
+        }
+        // a proven leaf may prove its ancestors
+        int i = t.depth - 1;
+        while (i > 0 && t.path[i]->proof.load(std::memory_order_relaxed) && prove(*t.tree, t.path[i - 1])) {
+            i--;
+        }
+    }
 
-            //if banned spot, update top
-            if (last_y == noY && last_x - 1 == noX) {
-                current_top[last_y]--;
-            }  
+    // all moves as first: every child whose spot was taken later in the iteration by the player to move at its parent
+    // also gets the result, current holds the board at the end of the rollout
+    void updateAmaf(Worker &t, int profit) {
+        NodePool &pool = *t.tree->pool;
+        const Position &final = t.current;
+        for (int i = 0; i < t.depth; i++) {
+            UCTNode *node = t.path[i];
+            uint32_t first = node->children.load(std::memory_order_acquire);
+            if (!first || first >= UCTNode::LINK) {
+                continue;
+            }
+            const Bitboard &stones = final.stones[node->ai_turn];
+            int expanded = node->expanded();
+            for (int k = 0; k < expanded; k++) {
+                UCTNode *slot = &pool[first + k];
+                if (stones.test(final.bit(slot->move_x, slot->move_y))) {
+                    AmafStats &amaf = pool.amafOf(t.tree->resolve(slot));
+                    amaf.visits.fetch_add(1, std::memory_order_relaxed);
+                    amaf.profit.fetch_add(profit, std::memory_order_relaxed);
+                }
+            }
         }
+    }
 
-        delete[] current_top;
-        for (int i = 0; i < h; i++)
-            delete[] current_board[i];
-        delete[] current_board;
-        return profit;
+    // MCTS-Solver: the player to move at node wins if one child is a proven win for them,
+    // and loses if every child is a proven loss, returns whether node is proven
+    static bool prove(SearchTree &tree, UCTNode *node) {
+        if (node->proof.load(std::memory_order_relaxed)) {
+            return true;
+        }
+        uint32_t first = node->children.load(std::memory_order_acquire);
+        if (!first || first >= UCTNode::LINK) {
+            return false;
+        }
+        int8_t win = node->ai_turn ? UCTNode::PROVEN_AI : UCTNode::PROVEN_USER;
+        bool lost = true;
+        for (int i = 0; i < node->child_count; i++) {
+            int8_t proof = tree.resolve(&(*tree.pool)[first + i])->proof.load(std::memory_order_relaxed);
+            if (proof == win) {
+                node->proof.store(win, std::memory_order_relaxed);
+                return true;
+            }
+            lost = lost && proof == -win;
+        }
+        if (lost) {
+            node->proof.store(-win, std::memory_order_relaxed);
+        }
+        return lost;
     }
 
-    //update the profit along the ancestor nodes
-    void backpropagate(UCTNode* current_node, double profit) {
-        while (current_node) {
-            current_node->visit_count++;
-            current_node->profit += profit;
-            current_node = current_node->parent;
+    // statistics of the moves at the root, added up over all trees
+    // a move is proven if any tree proved it
+    void rootStats(uint32_t *visits, int32_t *profit, int8_t *proof) {
+        for (int i = 0; i < w; i++) {
+            visits[i] = 0;
+            profit[i] = 0;
+            proof[i] = 0;
+        }
+        for (SearchTree *tree : trees) {
+            std::lock_guard<std::mutex> guard(tree->lock); // its own thread may be pruning it
+            for (int i = 0; i < tree->root->expanded(); i++) {
+                UCTNode *slot = &(*tree->pool)[tree->root->children + i];
+                UCTNode *child = tree->resolve(slot);
+                visits[slot->move_y] += child->visit_count.load(std::memory_order_relaxed);
+                profit[slot->move_y] += child->profit.load(std::memory_order_relaxed);
+                if (child->proof.load(std::memory_order_relaxed)) {
+                    proof[slot->move_y] = child->proof.load(std::memory_order_relaxed);
+                }
+            }
         }
     }
 
     //determine the best move from root to next
-    UCTNode* bestMove() {
-        double best_UCB = -RAND_MAX;
-        UCTNode* best = nullptr;
+    // a proven win is returned at once, moves proven to lose are only taken when every searched move loses
+    int bestMove() {
+        uint32_t visits[MAX_SIZE];
+        int32_t profit[MAX_SIZE];
+        int8_t proof[MAX_SIZE];
+        rootStats(visits, profit, proof);
+        for (int i = 0; i < w; i++) {
+            if (proof[i] == UCTNode::PROVEN_AI) {
+                return i;
+            }
+        }
 
+        double best_UCB = -RAND_MAX;
+        int best = -1;
         for (int i = 0; i < w; i++) {
-            if (root->children[i]) {
+            if (visits[i] && proof[i] != UCTNode::PROVEN_USER) {
                 // we only consider the exploitation term
-                double temp_UCB = (root->ai_turn ? 1 : -1) * root->children[i]->profit / (double)(root->children[i]->visit_count);
+                double temp_UCB = profit[i] / (double)visits[i];
                 if (temp_UCB > best_UCB) {
-                    best = root->children[i];
+                    best = i;
                     best_UCB = temp_UCB;
                 }
             }
         }
+        if (best == -1) { // every searched move loses, delay the loss as long as the statistics suggest
+            for (int i = 0; i < w; i++) {
+                if (visits[i] && profit[i] / (double)visits[i] > best_UCB) {
+                    best = i;
+                    best_UCB = profit[i] / (double)visits[i];
+                }
+            }
+        }
+        // nothing was searched, take any legal move
+        for (int i = 0; best == -1; i++) {
+            if (root_pos.canPlay(i)) {
+                best = i;
+            }
+        }
 
         return best;
     }
+
+    // pool index of the node reached from node by the move in column y, NONE if it was not expanded
+    static uint32_t findChild(SearchTree &tree, UCTNode *node, int y) {
+        for (int i = 0; i < node->expanded(); i++) {
+            UCTNode &slot = (*tree.pool)[node->children + i];
+            if (slot.move_y == y) {
+                uint32_t first = slot.children.load();
+                return UCTNode::isLink(first) ? first & ~UCTNode::LINK : node->children + i;
+            }
+        }
+        return NodePool::NONE;
+    }
+
+    // copy the subtree below node into the empty pool dest, its root ends up at index 0
+    // children blocks are copied breadth first, so dest itself serves as the queue
+    // links become leaves, the node they point to may not be part of the subtree
+    // nodes other than the root with fewer than min_visits visits keep their statistics but lose their children
+    static void copyTree(NodePool &from, uint32_t node, NodePool &dest, uint32_t min_visits = 0) {
+        dest.copy(dest.allocate(1), from, node);
+        for (uint32_t i = 0; i < dest.used(); i++) {
+            UCTNode &copy = dest[i];
+            if (UCTNode::isLink(copy.children)) { // a link is never terminal, but may be proven
+                // the leaf keeps the prior of the slot, with no visits bestChild would take it for a claimed child
+                copy.proof.store(from[copy.children & ~UCTNode::LINK].proof.load(std::memory_order_relaxed), std::memory_order_relaxed);
+                copy.children = 0;
+                copy.child_count = 0;
+                copy.expanded_count = 0;
+            } else if (copy.children && i && copy.visit_count < min_visits) {
+                copy.children = 0;
+                copy.child_count = 0;
+                copy.expanded_count = 0;
+            } else if (copy.children) {
+                uint32_t first = dest.allocate(copy.child_count);
+                for (int k = 0; k < copy.child_count; k++) {
+                    dest.copy(first + k, from, copy.children + k);
+                }
+                copy.children = first;
+            }
+        }
+    }
 };
+
+// a new search for boards of H rows and W columns
+template<int H, int W>
+Search* createSearch() {
+    return new UCT<H, W>();
+}
+
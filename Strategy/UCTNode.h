@@ -1,81 +1,101 @@
 #pragma once
-#include"Judge.h"
+#include"Position.h"
+#include<atomic>
+#include<cstdint>
 
 /**
  * a node in UCT
- * stores the current board and other data relevant to the UCT algorithm
+ * stores only the move leading to it and the statistics of the UCT algorithm,
+ * the board is rebuilt by replaying the moves from the root during the descent
+ * nodes live in a NodePool, the children of a node occupy consecutive slots of the pool
+ * the statistics are atomic so that several threads can search the same tree
+ * a child whose position already has a node elsewhere in the tree (a transposition) is a link:
+ * it keeps its own move, but children holds LINK | the index of that node, which owns the statistics
+ * wins and losses proven by the search (MCTS-Solver) are kept in proof, from the point of view of the ai
+ * the RAVE statistics are kept apart, in the pool (AmafStats), so that nodes stay small while RAVE is off
  */
 class UCTNode {
-    friend class UCT;
+    template<int H, int W> friend class UCT;
+    friend struct SearchTree;
 private:
-    int **board; // 0: empty, 1: user, 2: ai (strategy)
-    int h, w; // dimensions of the board
-    int *top; // top spot of each column
-    int noX, noY; // banned coordinates
-    int move_x; // x-coordinate of the move
-    int move_y; // y-coordinate of the move
+    std::atomic<uint32_t> visit_count; // number of times visited
+    std::atomic<int32_t> profit; // sum of the results, +1 ai wins, -1 user wins
+    std::atomic<uint32_t> children; // pool index of the first child, 0 while the children are not allocated
+    uint8_t child_count; // number of children (legal moves)
+    std::atomic<uint8_t> expanded_count; // children [0, expanded_count) have been claimed for expansion
+    int8_t move_x; // x-coordinate of the move
+    int8_t move_y; // y-coordinate of the move
     bool ai_turn; // whether it is the turn of the ai
-    int visit_count; // number of times visited
-    double profit;
-    UCTNode *parent; // parent node
-    UCTNode **children; // stores children (expanded nodes)
-    int expandable_count; // number of nodes that can be expanded
-    int *expandable_nodes; // list of nodes that can be expanded
-    int terminal; // is terminal node (i.e., win, lose, tie)
+    bool terminal; // is terminal node (i.e., win, lose, tie)
+    std::atomic<int8_t> proof; // game theoretic value once proven (PROVEN_AI, PROVEN_USER), 0 while unknown
 public:
-    // constructor
-    UCTNode(int **_board, int _h, int _w, const int *_top, int _noX = -1, int _noY = -1, int _move_x = -1, int _move_y = -1, bool _ai_turn = true, UCTNode *_parent = nullptr)
-        : h(_h), w(_w), noX(_noX), noY(_noY), move_x(_move_x), move_y(_move_y), ai_turn(_ai_turn), visit_count(0), profit(0),
-          parent(_parent), children(new UCTNode*[_w]), expandable_count(0), expandable_nodes(new int[_w]), terminal(-1) {
-        // set up the board
-        board = new int*[h];
-        for (int i = 0; i < h; i++) {
-            board[i] = new int[w];
-            for (int j = 0; j < w; j++) {
-                board[i][j] = _board[i][j];
-            }
-        }
+    static const uint32_t BUSY = 0xFFFFFFFF; // value of children while a thread is allocating them
+    static const uint32_t LINK = 0x80000000; // flag of children marking a link, no pool gets this large
+    static const int8_t PROVEN_AI = 1; // the ai wins with perfect play, same sign as profit
+    static const int8_t PROVEN_USER = -1; // the user wins with perfect play
 
-        top = new int[w];
-        for (int i = 0; i < w; i++) {
-            top[i] = _top[i];
-            if (top[i]) { // if not full
-                expandable_nodes[expandable_count++] = i; // add as a possible move
-            }
-            children[i] = nullptr;
-        }
+    // whether the value of children is a link
+    static bool isLink(uint32_t first) {
+        return first != BUSY && (first & LINK);
     }
-    // destructor
-    ~UCTNode() {
-        delete[] expandable_nodes;
-        delete[] top;
-        for (int i = 0; i < h; i++)
-            delete[] board[i];
-        delete[] board;
-        for (int i = 0; i < w; i++) {
-            if (children[i])
-                delete children[i];
-        }
-        delete[] children;
+
+    // nodes are carved out of raw pool memory, so they are set up here instead of in a constructor
+    void init(int _move_x, int _move_y, bool _ai_turn) {
+        visit_count.store(0, std::memory_order_relaxed);
+        profit.store(0, std::memory_order_relaxed);
+        children.store(0, std::memory_order_relaxed);
+        child_count = 0;
+        expanded_count.store(0, std::memory_order_relaxed);
+        move_x = _move_x;
+        move_y = _move_y;
+        ai_turn = _ai_turn;
+        terminal = false;
+        proof.store(0, std::memory_order_relaxed);
+    }
+    // copying is only done while no search is running
+    UCTNode& operator=(const UCTNode &o) {
+        visit_count.store(o.visit_count.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        profit.store(o.profit.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        children.store(o.children.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        child_count = o.child_count;
+        expanded_count.store(o.expanded_count.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        move_x = o.move_x;
+        move_y = o.move_y;
+        ai_turn = o.ai_turn;
+        terminal = o.terminal;
+        proof.store(o.proof.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        return *this;
+    }
+    // number of children that have been expanded, claims of other threads may overshoot child_count
+    int expanded() const {
+        int count = expanded_count.load(std::memory_order_relaxed);
+        return count < child_count ? count : child_count;
     }
     bool expandable() {
-        return expandable_count > 0;
+        uint32_t first = children.load(std::memory_order_acquire);
+        return !first || first >= LINK || expanded_count.load(std::memory_order_relaxed) < child_count;
     }
     bool isTerminal() {
-        if (terminal != -1) { // already set
-            return terminal;
-        }
-        // determine whether game is over
-        if (move_x == -1 && move_y == -1) { // game just started
-            terminal = 0;
-        } else if ((ai_turn && userWin(move_x, move_y, h, w, board)) || (!ai_turn && machineWin(move_x, move_y, h, w, board)) || isTie(w, top)){
-            terminal = 1;
-        } else {
-            terminal = 0;
-        }
         return terminal;
     }
-    void removeExpandableNode(int rank) {
-        expandable_nodes[rank] = expandable_nodes[--expandable_count];
+};
+
+/**
+ * RAVE statistics of a node, in a side array of the pool at the index of the node
+ * only allocated with RAVE on
+ */
+struct AmafStats {
+    std::atomic<uint32_t> visits; // iterations in which the move was played later by the same player
+    std::atomic<int32_t> profit; // sum of the results of those iterations
+
+    void clear() {
+        visits.store(0, std::memory_order_relaxed);
+        profit.store(0, std::memory_order_relaxed);
+    }
+    // copying is only done while no search is running
+    AmafStats& operator=(const AmafStats &o) {
+        visits.store(o.visits.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        profit.store(o.profit.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        return *this;
     }
-};
\ No newline at end of file
+};